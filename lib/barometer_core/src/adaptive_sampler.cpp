@@ -0,0 +1,121 @@
+#include <math.h>
+#include "adaptive_sampler.h"
+
+static const uint32_t bucket_upto_ms[SAMPLER_BUCKETS] = {1000, 2000, 5000, 10000, 30000, 60000, 120000, UINT32_MAX};
+
+AdaptiveSampler::AdaptiveSampler(uint32_t min_ms, uint32_t max_ms, float step_pa, float noise_pa)
+    : _min_ms(min_ms), _max_ms(max_ms > min_ms ? max_ms : min_ms), _step_pa(step_pa), _noise_pa(noise_pa), _head(0),
+      _n(0), _mean_s(0.0f), _mean_pa(0.0f), _slope(0.0f), _residual(0.0f), _t0(0), _interval(min_ms), _last_ms(0),
+      _jumps(0), _samples(0)
+{
+    for (uint8_t i = 0; i < SAMPLER_BUCKETS; i++)
+    {
+        _bucket[i].upto_ms = bucket_upto_ms[i];
+        _bucket[i].samples = 0;
+        _bucket[i].seconds = 0.0f;
+    }
+}
+
+//====================================================
+// update: Adds a reading taken at t_ms (millis()) and
+// returns the interval to the next one.
+//====================================================
+uint32_t AdaptiveSampler::update(uint32_t t_ms, float pressure_pa)
+{
+    bool jump = false;
+
+    // Book the reading under the interval that was scheduled for it
+    if (_samples > 0)
+    {
+        uint8_t b = 0;
+        while (_interval > _bucket[b].upto_ms)
+            b++;
+        _bucket[b].samples++;
+        _bucket[b].seconds += (t_ms - _last_ms) / 1000.0f;
+    }
+    _samples++;
+    _last_ms = t_ms;
+
+    if (_n >= 3)
+    {
+        float predicted = _mean_pa + _slope * ((t_ms - _t0) / 1000.0f - _mean_s);
+        float jump_pa = 4.0f * _noise_pa > _step_pa ? 4.0f * _noise_pa : _step_pa;
+        if (fabsf(pressure_pa - predicted) > jump_pa)
+        {
+            jump = true;
+            _jumps++;
+            _n = 0; // The old trend no longer holds
+        }
+    }
+
+    _t[_head] = t_ms;
+    _p[_head] = pressure_pa;
+    _head = (_head + 1) % SAMPLER_WINDOW;
+    if (_n < SAMPLER_WINDOW)
+        _n++;
+
+    fit();
+    _interval = next_interval(jump);
+    return _interval;
+}
+
+//====================================================
+// fit: Least squares line through the readings in the
+// ring, times relative to the oldest one.
+//====================================================
+void AdaptiveSampler::fit(void)
+{
+    uint8_t first = (_head + SAMPLER_WINDOW - _n) % SAMPLER_WINDOW;
+    float sum_t = 0.0f, sum_p = 0.0f, stt = 0.0f, stp = 0.0f, srr = 0.0f;
+
+    _t0 = _t[first];
+    for (uint8_t k = 0; k < _n; k++)
+    {
+        uint8_t i = (first + k) % SAMPLER_WINDOW;
+        sum_t += (_t[i] - _t0) / 1000.0f;
+        sum_p += _p[i];
+    }
+    _mean_s = sum_t / _n;
+    _mean_pa = sum_p / _n;
+
+    for (uint8_t k = 0; k < _n; k++)
+    {
+        uint8_t i = (first + k) % SAMPLER_WINDOW;
+        float dt = (_t[i] - _t0) / 1000.0f - _mean_s;
+        stt += dt * dt;
+        stp += dt * (_p[i] - _mean_pa);
+    }
+    _slope = stt > 0.0f ? stp / stt : 0.0f;
+
+    for (uint8_t k = 0; k < _n; k++)
+    {
+        uint8_t i = (first + k) % SAMPLER_WINDOW;
+        float r = _p[i] - _mean_pa - _slope * ((_t[i] - _t0) / 1000.0f - _mean_s);
+        srr += r * r;
+    }
+    _residual = _n > 2 ? sqrtf(srr / (_n - 2)) : 0.0f;
+}
+
+uint32_t AdaptiveSampler::next_interval(bool jump)
+{
+    float target_ms;
+
+    if (jump || _n < 3)
+        return _min_ms; // No trend yet
+
+    // Time for the trend to move step_pa
+    float rate = fabsf(_slope);
+    target_ms = rate > 0.0f ? 1000.0f * _step_pa / rate : (float)_max_ms;
+
+    // More scatter than the sensor has, the line does not tell the whole story
+    if (_residual > _noise_pa)
+        target_ms *= (_noise_pa / _residual) * (_noise_pa / _residual);
+
+    if (target_ms > 2.0f * _interval)
+        target_ms = 2.0f * _interval;
+    if (target_ms > _max_ms)
+        return _max_ms;
+    if (target_ms < _min_ms)
+        return _min_ms;
+    return (uint32_t)target_ms;
+}
@@ -0,0 +1,76 @@
+#ifndef ADAPTIVE_SAMPLER_H
+#define ADAPTIVE_SAMPLER_H
+
+//====================================================
+// adaptive_sampler: Picks the time to the next pressure
+// reading from how fast the pressure moves.
+//
+// A straight line is fitted through the last readings.
+// The next reading is due when the trend has moved the
+// pressure by step_pa. Scatter around the line beyond
+// the sensor noise (gusts, a front arriving) shortens
+// the interval further. A reading that misses the trend
+// by a jump (4x noise, at least step_pa) drops the fit
+// and samples at min_ms until a new trend is known.
+// The interval at most doubles per reading, so it backs
+// off gradually once things calm down.
+//
+// Every reading is counted in a histogram by the
+// interval that was scheduled for it, with the time it
+// covered, as a sampling rate report.
+//====================================================
+
+#include <stdint.h>
+
+#define SAMPLER_WINDOW 8  // Readings in the trend fit
+#define SAMPLER_BUCKETS 8 // Interval histogram buckets
+
+struct sampler_bucket
+{
+    uint32_t upto_ms; // Intervals up to this long
+    uint32_t samples; // Readings taken at such an interval
+    float seconds;    // Time covered by those readings
+};
+
+class AdaptiveSampler
+{
+public:
+    AdaptiveSampler(uint32_t min_ms = 1000, uint32_t max_ms = 300000, float step_pa = 2.0f, float noise_pa = 1.0f);
+
+    uint32_t update(uint32_t t_ms, float pressure_pa); // Returns the interval to the next reading
+    uint32_t interval(void) const { return _interval; }
+    float slope(void) const { return _slope; }       // Trend [Pa/s]
+    float residual(void) const { return _residual; } // Scatter around the trend [Pa rms]
+    uint32_t jumps(void) const { return _jumps; }
+
+    uint32_t samples(void) const { return _samples; }
+    const sampler_bucket &bucket(uint8_t i) const { return _bucket[i < SAMPLER_BUCKETS ? i : SAMPLER_BUCKETS - 1]; }
+
+private:
+    void fit(void);
+    uint32_t next_interval(bool jump);
+
+    uint32_t _min_ms;
+    uint32_t _max_ms;
+    float _step_pa;
+    float _noise_pa;
+
+    uint32_t _t[SAMPLER_WINDOW]; // Ring of readings
+    float _p[SAMPLER_WINDOW];
+    uint8_t _head;
+    uint8_t _n;
+
+    float _mean_s;  // Fit: mean time [s after _t0]
+    float _mean_pa; // Fit: mean pressure
+    float _slope;
+    float _residual;
+    uint32_t _t0;
+
+    uint32_t _interval;
+    uint32_t _last_ms;
+    uint32_t _jumps;
+    uint32_t _samples;
+    sampler_bucket _bucket[SAMPLER_BUCKETS];
+};
+
+#endif
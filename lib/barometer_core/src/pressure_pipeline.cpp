@@ -0,0 +1,161 @@
+#include <math.h>
+#include "pressure_pipeline.h"
+
+//====================================================
+// baro_sea_level: Reduces the station pressure to sea
+// level for the station height [m] and temperature [C]
+// (barometric formula, standard lapse rate).
+//====================================================
+double baro_sea_level(double station_hpa, double temp_c, double height_m)
+{
+    double correction = -station_hpa + station_hpa / pow((1.0 - (0.0065 * height_m / (temp_c + 0.0065 * height_m + 273.15))), 5.25588);
+
+    return station_hpa + correction;
+}
+
+//====================================================
+// baro_shift_slots: Shifts all slots back by one hour
+// and puts 'now' into slot 0. Without history (slot 0
+// still 0) all slots start flat at 'now', which keeps
+// the scale window on real data.
+//====================================================
+void baro_shift_slots(int16_t *slots, uint8_t count, int16_t now)
+{
+    if (slots[0] == 0)
+    {
+        for (uint8_t i = 0; i < count; i++)
+            slots[i] = now;
+    }
+
+    for (uint8_t i = count - 1; i > 0; i--)
+        slots[i] = slots[i - 1];
+    slots[0] = now;
+}
+
+//====================================================
+// baro_to_meter: Maps a pressure [hPa] into the meter
+// scale [0,100] of the window. Values outside the
+// window are left outside [0,100], the arrows clamp to
+// end stops.
+//====================================================
+int16_t baro_to_meter(int16_t hpa, const pressure_window &w)
+{
+    float range_delta = (w.max - w.min) / 100.0;
+
+    return (int16_t)((hpa - w.min) / range_delta);
+}
+
+//====================================================
+// baro_map_slots: Maps the slots into the meter scale.
+// Call right after baro_shift_slots(). Unless full_remap
+// is set (window moved, or first reading), the mapped
+// history is shifted one hour like the slots and only
+// the 'Now' value is mapped.
+//====================================================
+void baro_map_slots(const int16_t *slots, int16_t *meter, uint8_t count, const pressure_window &w, bool full_remap)
+{
+    if (full_remap)
+    {
+        for (uint8_t i = 0; i < count; i++)
+            meter[i] = baro_to_meter(slots[i], w);
+        return;
+    }
+
+    for (uint8_t i = count - 1; i > 0; i--)
+        meter[i] = meter[i - 1];
+    meter[0] = baro_to_meter(slots[0], w);
+}
+
+//====================================================
+// baro_outside_window: Returns 999 if some slot is above
+// the window, -999 if some slot is below it, and 0 if
+// all fit or slots are both above and below.
+//====================================================
+int16_t baro_outside_window(const int16_t *slots, uint8_t count, const pressure_window &w)
+{
+    bool over = false, under = false;
+
+    for (uint8_t i = 0; i < count; i++)
+    {
+        if (slots[i] > w.max)
+            over = true;
+        if (slots[i] < w.min)
+            under = true;
+    }
+
+    if (over && under)
+        return 0; // Cannot do anything if the slots exceed the window span
+    if (over)
+        return 999;
+    if (under)
+        return -999;
+    return 0;
+}
+
+//====================================================
+// baro_snap_down: Snaps 'value' down to the 'step' grid,
+// also below zero where C++ '%' truncates towards zero.
+//====================================================
+static int16_t baro_snap_down(int16_t value, int16_t step)
+{
+    return value - ((value % step) + step) % step;
+}
+
+//====================================================
+// baro_select_window: Keeps the window as long as the
+// slots fit (hysteresis), otherwise centres a new
+// window of 'span' hPa on them, snapped to 'step'. If
+// the snapped window would cut off slots that fit into
+// 'span', it moves up to the grid point that holds
+// them all; if no grid point does, it keeps 'Now' on
+// the scale. If the slots are wider than a window, the
+// window follows 'Now' once it gets within 'margin' of
+// an edge. Returns true if the window moved.
+//====================================================
+bool baro_select_window(const int16_t *slots, uint8_t count, pressure_window &w, int16_t span, int16_t step,
+                        int16_t margin)
+{
+    int16_t lo = slots[0];
+    int16_t hi = slots[0];
+    int16_t centre;
+    int16_t new_min;
+    int16_t fit_min;
+    int16_t fit_max;
+
+    for (uint8_t i = 1; i < count; i++)
+    {
+        if (slots[i] < lo)
+            lo = slots[i];
+        if (slots[i] > hi)
+            hi = slots[i];
+    }
+
+    if (baro_outside_window(slots, count, w) != 0)
+        centre = (lo + hi) / 2; // Over- or under pressure only
+    else if (lo >= w.min && hi <= w.max)
+        return false; // All values fit, keep the window
+    else if (slots[0] >= w.min + margin && slots[0] <= w.max - margin)
+        return false; // History too wide for any window, 'Now' still well inside
+    else
+        centre = slots[0];
+
+    new_min = baro_snap_down(centre - span / 2, step);
+
+    if (hi - lo <= span)
+    {
+        // Every window with its min in [hi - span, lo] holds all slots, the snapped centre is never above lo
+        fit_min = baro_snap_down(hi - span + step - 1, step);
+        fit_max = baro_snap_down(lo, step);
+        if (fit_min <= lo)
+            new_min = new_min < fit_min ? fit_min : new_min;
+        else
+            new_min = slots[0] > fit_max + span ? fit_min : fit_max; // No grid point fits both ends
+    }
+
+    if (new_min == w.min)
+        return false;
+
+    w.min = new_min;
+    w.max = new_min + span;
+    return true;
+}
@@ -0,0 +1,45 @@
+#ifndef PRESSURE_PIPELINE_H
+#define PRESSURE_PIPELINE_H
+
+//====================================================
+// pressure_pipeline: The firmware's data path from a
+// sensor reading to the six scales, as plain functions
+// without Arduino or display dependencies, so the
+// firmware and host tools (tools/fleet_analytics) run
+// the very same code.
+//
+//   baro_sea_level       station -> sea level pressure
+//   baro_shift_slots     hour slots, 'Now' in slot 0
+//   baro_select_window   auto-ranging with hysteresis
+//   baro_map_slots       slots -> meter scale [0,100]
+//
+// Pressures in the slots are whole hPa (int16), as the
+// firmware keeps them.
+//====================================================
+
+#include <stdint.h>
+
+// Scale settings of the firmware, also used by the host tools
+#define MINPRESSURE 995     // hPa/mbar, scale window at power up
+#define MAXPRESSURE 1035    // hPa/mbar
+#define PRESSUREWINDOW 40   // hPa/mbar shown on the scales, auto-ranged
+#define WINDOWSTEP 5        // Scale window edges snap to this step
+#define WINDOWMARGIN 2      // 'Now' distance to window edge before following
+#define MAXHOURTIMESLOT 11  // Number of possible one hour time slots
+#define HOURSLOT_MS 3600000 // One hour time slot
+
+struct pressure_window
+{
+    int16_t min; // hPa/mbar at the bottom of the scales
+    int16_t max; // hPa/mbar at the top
+};
+
+double baro_sea_level(double station_hpa, double temp_c, double height_m);
+void baro_shift_slots(int16_t *slots, uint8_t count, int16_t now);
+int16_t baro_to_meter(int16_t hpa, const pressure_window &w);
+void baro_map_slots(const int16_t *slots, int16_t *meter, uint8_t count, const pressure_window &w, bool full_remap);
+int16_t baro_outside_window(const int16_t *slots, uint8_t count, const pressure_window &w);
+bool baro_select_window(const int16_t *slots, uint8_t count, pressure_window &w, int16_t span, int16_t step,
+                        int16_t margin);
+
+#endif
@@ -0,0 +1,33 @@
+#include "sample_history.h"
+
+SampleHistory::SampleHistory(baro_sample *storage, uint16_t capacity)
+    : _storage(storage), _capacity(capacity), _next(0)
+{
+}
+
+void SampleHistory::begin(baro_sample *storage, uint16_t capacity)
+{
+    _storage = storage;
+    _capacity = storage ? capacity : 0;
+    _next = 0;
+}
+
+void SampleHistory::push(const baro_sample &s)
+{
+    if (_capacity == 0)
+        return;
+    _storage[_next % _capacity] = s;
+    _next++;
+}
+
+//====================================================
+// get: Copies sample 'seq' to out. Returns false if it
+// is not written yet or already overwritten.
+//====================================================
+bool SampleHistory::get(uint32_t seq, baro_sample &out) const
+{
+    if (seq < first_seq() || seq >= _next)
+        return false;
+    out = _storage[seq % _capacity];
+    return true;
+}
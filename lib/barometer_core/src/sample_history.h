@@ -0,0 +1,44 @@
+#ifndef SAMPLE_HISTORY_H
+#define SAMPLE_HISTORY_H
+
+//====================================================
+// sample_history: Ring buffer of the latest samples in
+// caller provided storage. Every sample gets a sequence
+// number, so readers (e.g. a slow HTTP client) can walk
+// the ring with a cursor and notice when the oldest
+// samples have been overwritten under them.
+//====================================================
+
+#include <stddef.h>
+#include <stdint.h>
+
+struct baro_sample
+{
+    uint32_t t_ms;     // millis() at the reading
+    int32_t pressure;  // Sea level pressure [Pa], aka 1/100 hPa
+    int16_t temp;      // Temperature [1/100 C]
+    uint16_t humidity; // Relative humidity [1/100 %RH]
+};
+
+class SampleHistory
+{
+public:
+    SampleHistory(baro_sample *storage = NULL, uint16_t capacity = 0);
+
+    void begin(baro_sample *storage, uint16_t capacity); // Storage allocated later, e.g. from the arena
+
+    void push(const baro_sample &s);
+    bool get(uint32_t seq, baro_sample &out) const;
+
+    uint32_t first_seq(void) const { return _next > _capacity ? _next - _capacity : 0; }
+    uint32_t next_seq(void) const { return _next; }
+    uint16_t size(void) const { return (uint16_t)(_next - first_seq()); }
+    uint16_t capacity(void) const { return _capacity; }
+
+private:
+    baro_sample *_storage;
+    uint16_t _capacity;
+    uint32_t _next; // Sequence number of the next sample
+};
+
+#endif
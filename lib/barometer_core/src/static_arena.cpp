@@ -0,0 +1,30 @@
+#include <string.h>
+#include "static_arena.h"
+
+StaticArena::StaticArena(uint8_t *storage, size_t size)
+    : _storage(storage), _size(size), _used(0), _allocations(0), _failed(0), _late(0), _sealed(false)
+{
+}
+
+void *StaticArena::alloc(size_t size, size_t align)
+{
+    if (_sealed)
+    {
+        _late++;
+        return NULL;
+    }
+
+    // Align the address, not just the offset, the storage may start anywhere
+    uintptr_t base = (uintptr_t)_storage;
+    size_t start = (size_t)(((base + _used + align - 1) & ~(uintptr_t)(align - 1)) - base);
+    if (start > _size || size > _size - start)
+    {
+        _failed++;
+        return NULL;
+    }
+
+    _used = start + size;
+    _allocations++;
+    memset(_storage + start, 0, size);
+    return _storage + start;
+}
@@ -0,0 +1,50 @@
+#ifndef STATIC_ARENA_H
+#define STATIC_ARENA_H
+
+//====================================================
+// static_arena: Bump allocator over one static buffer
+// for the runtime data (history ring, hour slots).
+// Everything is allocated once in setup() and never
+// freed. seal() closes the arena at the end of setup();
+// later allocations fail and are counted, so a stray
+// runtime allocation shows up in the memory report
+// instead of fragmenting the heap.
+//====================================================
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define ARENA_ALIGN 8
+
+class StaticArena
+{
+public:
+    StaticArena(uint8_t *storage, size_t size);
+
+    void *alloc(size_t size, size_t align = ARENA_ALIGN); // Zeroed, NULL if full or sealed
+    void seal(void) { _sealed = true; }
+
+    template <typename T> T *alloc_array(size_t count)
+    {
+        return (T *)alloc(count * sizeof(T), alignof(T));
+    }
+
+    size_t size(void) const { return _size; }
+    size_t used(void) const { return _used; }
+    size_t available(void) const { return _size - _used; }
+    uint16_t allocations(void) const { return _allocations; }
+    uint16_t failed(void) const { return _failed; } // Too big for what was left
+    uint16_t late(void) const { return _late; }     // Asked for after seal()
+    bool sealed(void) const { return _sealed; }
+
+private:
+    uint8_t *_storage;
+    size_t _size;
+    size_t _used;
+    uint16_t _allocations;
+    uint16_t _failed;
+    uint16_t _late;
+    bool _sealed;
+};
+
+#endif
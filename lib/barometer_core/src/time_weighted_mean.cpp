@@ -0,0 +1,35 @@
+#include "time_weighted_mean.h"
+
+TimeWeightedMean::TimeWeightedMean() : _area(0.0), _span_ms(0), _last_ms(0), _last(0.0f), _have_last(false)
+{
+}
+
+void TimeWeightedMean::add(uint32_t t_ms, float value)
+{
+    if (_have_last)
+    {
+        uint32_t dt = t_ms - _last_ms;
+        _area += 0.5 * ((double)_last + value) * dt;
+        _span_ms += dt;
+    }
+    _last_ms = t_ms;
+    _last = value;
+    _have_last = true;
+}
+
+void TimeWeightedMean::restart(void)
+{
+    _area = 0.0;
+    _span_ms = 0;
+}
+
+//====================================================
+// mean: The time weighted mean since restart(), or the
+// last reading if no time has passed yet.
+//====================================================
+float TimeWeightedMean::mean(void) const
+{
+    if (_span_ms == 0)
+        return _last;
+    return (float)(_area / _span_ms);
+}
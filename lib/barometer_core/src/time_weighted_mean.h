@@ -0,0 +1,33 @@
+#ifndef TIME_WEIGHTED_MEAN_H
+#define TIME_WEIGHTED_MEAN_H
+
+//====================================================
+// time_weighted_mean: Mean of a value over a period from
+// readings at uneven intervals. Each stretch between two
+// readings counts with its length (trapezoid rule), so
+// a burst of fast readings during a squall does not
+// outweigh the calm hours around it.
+//====================================================
+
+#include <stdint.h>
+
+class TimeWeightedMean
+{
+public:
+    TimeWeightedMean();
+
+    void add(uint32_t t_ms, float value);
+    void restart(void); // New period, starting at the last reading
+    float mean(void) const;
+    uint32_t span_ms(void) const { return _span_ms; }
+    bool empty(void) const { return !_have_last; }
+
+private:
+    double _area; // Integral of the value [value * ms]
+    uint32_t _span_ms;
+    uint32_t _last_ms;
+    float _last;
+    bool _have_last;
+};
+
+#endif
@@ -0,0 +1,460 @@
+#include <ctype.h>
+#include "history_http.h"
+
+#define CHUNK_HEAD 6 // "XXXX\r\n"
+#define CHUNK_TAIL 2 // "\r\n"
+#define CHUNK_LAST 5 // "0\r\n\r\n"
+
+static const char busy_response[] = "HTTP/1.1 503 Service Unavailable\r\n"
+                                    "Content-Length: 0\r\nRetry-After: 1\r\nConnection: close\r\n\r\n";
+
+//====================================================
+// format_centi: Writes a 1/100 unit value as a decimal
+// number with two decimals, e.g. -5 as "-0.05".
+//====================================================
+static const char *format_centi(char *buf, size_t len, int32_t value)
+{
+    uint32_t v = value < 0 ? (uint32_t)(-(int64_t)value) : (uint32_t)value;
+    snprintf(buf, len, "%s%lu.%02lu", value < 0 ? "-" : "", (unsigned long)(v / 100), (unsigned long)(v % 100));
+    return buf;
+}
+
+static int json_sample(char *dst, size_t room, uint32_t seq, const baro_sample &s)
+{
+    char p[16], t[16], h[16];
+    return snprintf(dst, room, "{\"seq\":%lu,\"ms\":%lu,\"hpa\":%s,\"temp_c\":%s,\"rh\":%s}", (unsigned long)seq,
+                    (unsigned long)s.t_ms, format_centi(p, sizeof(p), s.pressure), format_centi(t, sizeof(t), s.temp),
+                    format_centi(h, sizeof(h), s.humidity));
+}
+
+static void put_le(uint8_t *dst, uint32_t v, int bytes)
+{
+    for (int i = 0; i < bytes; i++)
+        dst[i] = (uint8_t)(v >> (8 * i));
+}
+
+//====================================================
+// header_value: Case-insensitive lookup of a request
+// header, returns the value (up to CR) or NULL.
+//====================================================
+static const char *header_value(const char *req, const char *name)
+{
+    size_t n = strlen(name);
+    for (const char *line = strstr(req, "\r\n"); line && line[2] != '\r'; line = strstr(line + 2, "\r\n"))
+    {
+        const char *h = line + 2;
+        size_t i = 0;
+        while (i < n && h[i] && tolower((unsigned char)h[i]) == tolower((unsigned char)name[i]))
+            i++;
+        if (i == n && h[n] == ':')
+        {
+            h += n + 1;
+            while (*h == ' ')
+                h++;
+            return h;
+        }
+    }
+    return NULL;
+}
+
+HistoryHttpServer::HistoryHttpServer(NetTransport &net, SampleHistory &history)
+    : _net(net), _history(history), _running(false)
+{
+    memset(&_stats, 0, sizeof(_stats));
+    for (int i = 0; i < HTTP_MAX_CLIENTS; i++)
+        _conn[i].state = CONN_FREE;
+}
+
+bool HistoryHttpServer::begin(uint16_t port)
+{
+    _running = _net.begin(port);
+    return _running;
+}
+
+uint8_t HistoryHttpServer::clients(void) const
+{
+    uint8_t n = 0;
+    for (int i = 0; i < HTTP_MAX_CLIENTS; i++)
+        if (_conn[i].state != CONN_FREE)
+            n++;
+    return n;
+}
+
+//====================================================
+// poll: Accepts new connections and moves every open
+// one forward without blocking. Call often from loop().
+//====================================================
+bool HistoryHttpServer::poll(void)
+{
+    bool progress = false;
+    int h;
+
+    if (!_running)
+        return false;
+
+    while ((h = _net.accept()) >= 0)
+    {
+        progress = true;
+
+        connection *c = NULL;
+        for (int i = 0; i < HTTP_MAX_CLIENTS && c == NULL; i++)
+            if (_conn[i].state == CONN_FREE)
+                c = &_conn[i];
+
+        if (c == NULL)
+        {
+            _net.write(h, (const uint8_t *)busy_response, sizeof(busy_response) - 1);
+            _net.close(h);
+            _stats.busy++;
+            continue;
+        }
+
+        c->handle = h;
+        c->state = CONN_REQUEST;
+        c->req_len = c->out_len = c->out_pos = 0;
+        c->since_ms = millis();
+    }
+
+    for (int i = 0; i < HTTP_MAX_CLIENTS; i++)
+    {
+        if (_conn[i].state != CONN_FREE && service(_conn[i]))
+            progress = true;
+    }
+
+    uint8_t n = clients();
+    if (n > _stats.max_clients)
+        _stats.max_clients = n;
+
+    return progress;
+}
+
+bool HistoryHttpServer::service(connection &c)
+{
+    uint8_t sink[32];
+    bool progress = false;
+
+    if (c.state == CONN_REQUEST)
+        return read_request(c);
+
+    // Nothing is expected after the request, this only notices a closed client
+    if (_net.read(c.handle, sink, sizeof(sink)) < 0)
+    {
+        drop(c);
+        return true;
+    }
+
+    for (int i = 0; i < HTTP_CHUNKS_PER_POLL; i++)
+    {
+        uint16_t before = c.out_pos;
+        int r = flush(c);
+        if (r < 0)
+            return true;
+        if (r == 0)
+            return progress || c.out_pos != before;
+        if (c.state == CONN_CLOSING)
+        {
+            drop(c);
+            return true;
+        }
+        if (!(c.state == CONN_HISTORY ? fill_history(c) : fill_live(c)))
+            return progress;
+        progress = true;
+    }
+    return progress;
+}
+
+bool HistoryHttpServer::read_request(connection &c)
+{
+    int n = _net.read(c.handle, (uint8_t *)c.req + c.req_len, HTTP_REQUEST_MAX - 1 - c.req_len);
+
+    if (n < 0 || (n == 0 && millis() - c.since_ms > HTTP_REQUEST_TIMEOUT_MS))
+    {
+        drop(c);
+        return true;
+    }
+    if (n == 0)
+        return false;
+
+    c.req_len += n;
+    c.req[c.req_len] = '\0';
+
+    if (strstr(c.req, "\r\n\r\n") != NULL)
+        start_response(c);
+    else if (c.req_len >= HTTP_REQUEST_MAX - 1)
+        respond(c, "431 Request Header Fields Too Large", "text/plain", "Request too large\n");
+    return true;
+}
+
+void HistoryHttpServer::start_response(connection &c)
+{
+    char *path = c.req + 4;
+    char *headers = path + strcspn(path, " \r");
+    char *query;
+    int n;
+
+    _stats.requests++;
+
+    if (strncmp(c.req, "GET ", 4) != 0)
+    {
+        respond(c, "405 Method Not Allowed", "text/plain", "Only GET\n");
+        return;
+    }
+    if (*headers)
+        *headers++ = '\0';
+    query = strchr(path, '?');
+    if (query)
+        *query++ = '\0';
+
+    if (strcmp(path, "/history") == 0)
+    {
+        const char *type = "application/json";
+        c.format = FORMAT_JSON;
+        if (query && strstr(query, "format=csv"))
+        {
+            c.format = FORMAT_CSV;
+            type = "text/csv";
+        }
+        else if (query && strstr(query, "format=bin"))
+        {
+            c.format = FORMAT_BINARY;
+            type = "application/octet-stream";
+        }
+        else if (query && strstr(query, "format=") && !strstr(query, "format=json"))
+        {
+            respond(c, "400 Bad Request", "text/plain", "format=json|csv|bin\n");
+            return;
+        }
+
+        n = snprintf((char *)c.out, HTTP_CHUNK_MAX,
+                     "HTTP/1.1 200 OK\r\nContent-Type: %s\r\nTransfer-Encoding: chunked\r\n"
+                     "Cache-Control: no-store\r\nConnection: close\r\n\r\n",
+                     type);
+        c.out_len = n;
+        c.out_pos = 0;
+        c.cursor = _history.first_seq();
+        c.end = _history.next_seq();
+        c.started = false;
+        c.comma = false;
+        c.state = CONN_HISTORY;
+        return;
+    }
+
+    if (strcmp(path, "/live") == 0)
+    {
+        const char *last_id = header_value(headers, "Last-Event-ID");
+
+        c.cursor = _history.next_seq();
+        if (last_id)
+        {
+            uint32_t resume = strtoul(last_id, NULL, 10) + 1;
+            if (resume >= _history.first_seq() && resume <= _history.next_seq())
+                c.cursor = resume;
+        }
+
+        n = snprintf((char *)c.out, HTTP_CHUNK_MAX,
+                     "HTTP/1.1 200 OK\r\nContent-Type: text/event-stream\r\nCache-Control: no-cache\r\n"
+                     "Connection: close\r\n\r\nretry: 5000\n\n");
+        c.out_len = n;
+        c.out_pos = 0;
+        c.since_ms = millis();
+        c.state = CONN_LIVE;
+        return;
+    }
+
+    if (strcmp(path, "/") == 0)
+    {
+        respond(c, "200 OK", "text/plain",
+                "Nautical Barometer Gold\n/history?format=json|csv|bin\n/live (Server-Sent Events)\n");
+        return;
+    }
+
+    respond(c, "404 Not Found", "text/plain", "Not found\n");
+}
+
+void HistoryHttpServer::respond(connection &c, const char *status, const char *type, const char *body)
+{
+    int n = snprintf((char *)c.out, HTTP_CHUNK_MAX,
+                     "HTTP/1.1 %s\r\nContent-Type: %s\r\nContent-Length: %u\r\nConnection: close\r\n\r\n%s", status,
+                     type, (unsigned)strlen(body), body);
+    c.out_len = n < HTTP_CHUNK_MAX ? n : HTTP_CHUNK_MAX - 1;
+    c.out_pos = 0;
+    c.state = CONN_CLOSING;
+}
+
+//====================================================
+// fill_history: Formats the next records from the ring
+// into one chunk. Queues the last chunk and switches to
+// closing once the cursor reaches the end of the
+// request snapshot.
+//====================================================
+bool HistoryHttpServer::fill_history(connection &c)
+{
+    char *payload = (char *)c.out + CHUNK_HEAD;
+    size_t room = HTTP_CHUNK_MAX - CHUNK_HEAD - CHUNK_TAIL - CHUNK_LAST;
+    size_t len = 0;
+    baro_sample s;
+
+    if (!c.started)
+    {
+        if (c.format == FORMAT_JSON)
+            payload[len++] = '[';
+        else if (c.format == FORMAT_CSV)
+            len = sprintf(payload, "seq,ms,pressure_hpa,temp_c,humidity_rh\r\n");
+        else
+        {
+            memcpy(payload, "BARO", 4);
+            put_le((uint8_t *)payload + 4, HTTP_BINARY_VERSION, 2);
+            put_le((uint8_t *)payload + 6, HTTP_BINARY_RECORD, 2);
+            len = 8;
+        }
+        c.started = true;
+    }
+
+    if (c.cursor < _history.first_seq())
+    {
+        _stats.skipped += _history.first_seq() - c.cursor;
+        c.cursor = _history.first_seq();
+    }
+
+    while (c.cursor < c.end && _history.get(c.cursor, s))
+    {
+        int n = format_record(c, payload + len, room - len, c.cursor, s);
+        if (n <= 0)
+            break;
+        len += n;
+        c.cursor++;
+    }
+
+    bool done = c.cursor >= c.end;
+    if (done && c.format == FORMAT_JSON)
+    {
+        if (room - len >= 2)
+        {
+            memcpy(payload + len, "]\n", 2);
+            len += 2;
+        }
+        else
+            done = false;
+    }
+
+    c.out_len = 0;
+    c.out_pos = 0;
+    if (len > 0)
+    {
+        static const char hex[] = "0123456789ABCDEF";
+        for (int i = 0; i < 4; i++)
+            c.out[i] = hex[(len >> (12 - 4 * i)) & 0xF];
+        memcpy(c.out + 4, "\r\n", 2);
+        memcpy(c.out + CHUNK_HEAD + len, "\r\n", 2);
+        c.out_len = CHUNK_HEAD + len + CHUNK_TAIL;
+    }
+    if (done)
+    {
+        memcpy(c.out + c.out_len, "0\r\n\r\n", CHUNK_LAST);
+        c.out_len += CHUNK_LAST;
+        c.state = CONN_CLOSING;
+    }
+    return c.out_len > 0;
+}
+
+int HistoryHttpServer::format_record(connection &c, char *dst, size_t room, uint32_t seq, const baro_sample &s)
+{
+    char p[16], t[16], h[16];
+    int n;
+
+    switch (c.format)
+    {
+    case FORMAT_JSON:
+        if (room < 2)
+            return 0;
+        if (c.comma)
+            *dst = ',';
+        n = json_sample(dst + c.comma, room - c.comma, seq, s);
+        if (n < 0 || (size_t)n >= room - c.comma)
+            return 0;
+        n += c.comma;
+        c.comma = true;
+        return n;
+
+    case FORMAT_CSV:
+        n = snprintf(dst, room, "%lu,%lu,%s,%s,%s\r\n", (unsigned long)seq, (unsigned long)s.t_ms,
+                     format_centi(p, sizeof(p), s.pressure), format_centi(t, sizeof(t), s.temp),
+                     format_centi(h, sizeof(h), s.humidity));
+        return (n < 0 || (size_t)n >= room) ? 0 : n;
+
+    default:
+        if (room < HTTP_BINARY_RECORD)
+            return 0;
+        put_le((uint8_t *)dst, seq, 4);
+        put_le((uint8_t *)dst + 4, s.t_ms, 4);
+        put_le((uint8_t *)dst + 8, (uint32_t)s.pressure, 4);
+        put_le((uint8_t *)dst + 12, (uint16_t)s.temp, 2);
+        put_le((uint8_t *)dst + 14, s.humidity, 2);
+        return HTTP_BINARY_RECORD;
+    }
+}
+
+//====================================================
+// fill_live: Queues an SSE event for every sample after
+// the cursor that fits the buffer, or a keep-alive
+// comment when the stream has been quiet.
+//====================================================
+bool HistoryHttpServer::fill_live(connection &c)
+{
+    char *dst = (char *)c.out;
+    size_t len = 0;
+    baro_sample s;
+
+    if (c.cursor < _history.first_seq())
+    {
+        _stats.skipped += _history.first_seq() - c.cursor;
+        c.cursor = _history.first_seq();
+    }
+
+    while (c.cursor < _history.next_seq() && _history.get(c.cursor, s))
+    {
+        char data[112];
+        json_sample(data, sizeof(data), c.cursor, s);
+        int n = snprintf(dst + len, HTTP_CHUNK_MAX - len, "id: %lu\nevent: sample\ndata: %s\n\n",
+                         (unsigned long)c.cursor, data);
+        if (n < 0 || (size_t)n >= HTTP_CHUNK_MAX - len)
+            break;
+        len += n;
+        c.cursor++;
+    }
+
+    if (len == 0 && millis() - c.since_ms >= HTTP_SSE_PING_MS)
+        len = sprintf(dst, ": ping\n\n");
+    if (len == 0)
+        return false;
+
+    c.out_len = len;
+    c.out_pos = 0;
+    c.since_ms = millis();
+    return true;
+}
+
+int HistoryHttpServer::flush(connection &c)
+{
+    while (c.out_pos < c.out_len)
+    {
+        int n = _net.write(c.handle, c.out + c.out_pos, c.out_len - c.out_pos);
+        if (n < 0)
+        {
+            drop(c);
+            return -1;
+        }
+        if (n == 0)
+            return 0;
+        c.out_pos += n;
+        _stats.bytes += n;
+    }
+    c.out_len = c.out_pos = 0;
+    return 1;
+}
+
+void HistoryHttpServer::drop(connection &c)
+{
+    _net.close(c.handle);
+    c.state = CONN_FREE;
+}
@@ -0,0 +1,113 @@
+#ifndef HISTORY_HTTP_H
+#define HISTORY_HTTP_H
+
+//====================================================
+// history_http: Small HTTP/1.1 server for the sample
+// history, polled from loop().
+//
+//   GET /history[?format=json|csv|bin]
+//       The whole ring, oldest first, as a chunked
+//       response. Records are formatted straight from
+//       the ring into one chunk buffer per connection.
+//   GET /live
+//       Server-Sent Events, one 'sample' event per new
+//       sample, resumes from Last-Event-ID while the
+//       ring still holds it.
+//
+// RAM is fixed: HTTP_MAX_CLIENTS connection slots with
+// one request and one chunk buffer each, nothing is
+// allocated. Extra clients get 503. Every response is
+// 'Connection: close'.
+//
+// Binary format: "BARO", u16 version, u16 record size,
+// then per sample (little endian) u32 seq, u32 t_ms,
+// i32 pressure [Pa], i16 temp [1/100 C], u16 humidity
+// [1/100 %RH].
+//====================================================
+
+#include <Arduino.h>
+#include <sample_history.h>
+#include "net_transport.h"
+
+#define HTTP_MAX_CLIENTS 4
+#define HTTP_REQUEST_MAX 384     // Request line + headers
+#define HTTP_CHUNK_MAX 512       // Per connection output buffer
+#define HTTP_CHUNKS_PER_POLL 8   // Fairness between connections
+#define HTTP_REQUEST_TIMEOUT_MS 5000
+#define HTTP_SSE_PING_MS 15000
+#define HTTP_BINARY_VERSION 1
+#define HTTP_BINARY_RECORD 16
+
+struct http_stats
+{
+    uint32_t requests;     // Requests answered
+    uint32_t busy;         // Connections turned away with 503
+    uint32_t bytes;        // Bytes sent
+    uint32_t skipped;      // Samples overwritten before a slow client got them
+    uint8_t max_clients;   // Most connection slots in use at once
+};
+
+class HistoryHttpServer
+{
+public:
+    HistoryHttpServer(NetTransport &net, SampleHistory &history);
+
+    bool begin(uint16_t port);
+    bool poll(void); // Returns true if there was something to do
+    uint8_t clients(void) const;
+    const http_stats &stats(void) const { return _stats; }
+
+    static size_t connection_size(void) { return sizeof(connection); }
+
+private:
+    enum conn_state
+    {
+        CONN_FREE,
+        CONN_REQUEST,
+        CONN_HISTORY,
+        CONN_LIVE,
+        CONN_CLOSING
+    };
+
+    enum history_format
+    {
+        FORMAT_JSON,
+        FORMAT_CSV,
+        FORMAT_BINARY
+    };
+
+    struct connection
+    {
+        int handle;
+        uint8_t state;
+        uint8_t format;
+        bool started;      // Body prefix queued
+        bool comma;        // JSON: next record needs a separator
+        uint32_t cursor;   // Next sample sequence number
+        uint32_t end;      // History: stop at this sequence number
+        uint32_t since_ms; // Request start, or last SSE write
+        uint16_t req_len;
+        uint16_t out_len;
+        uint16_t out_pos;
+        char req[HTTP_REQUEST_MAX];
+        uint8_t out[HTTP_CHUNK_MAX];
+    };
+
+    bool service(connection &c);
+    bool read_request(connection &c);
+    void start_response(connection &c);
+    void respond(connection &c, const char *status, const char *type, const char *body);
+    bool fill_history(connection &c);
+    bool fill_live(connection &c);
+    int format_record(connection &c, char *dst, size_t room, uint32_t seq, const baro_sample &s);
+    int flush(connection &c);
+    void drop(connection &c);
+
+    NetTransport &_net;
+    SampleHistory &_history;
+    bool _running;
+    http_stats _stats;
+    connection _conn[HTTP_MAX_CLIENTS];
+};
+
+#endif
@@ -0,0 +1,25 @@
+#ifndef NET_TRANSPORT_H
+#define NET_TRANSPORT_H
+
+//====================================================
+// net_transport: Minimal non-blocking TCP server
+// interface under the HTTP server. Connections are small
+// integer handles. WiFiTransport runs it on the ESP32,
+// PosixTransport on Linux for load tests over loopback.
+//====================================================
+
+#include <stddef.h>
+#include <stdint.h>
+
+class NetTransport
+{
+public:
+    virtual ~NetTransport() {}
+    virtual bool begin(uint16_t port) = 0;
+    virtual int accept(void) = 0;                                 // New connection handle, or -1
+    virtual int read(int h, uint8_t *buf, size_t len) = 0;        // Bytes read, 0 if none yet, -1 if closed
+    virtual int write(int h, const uint8_t *buf, size_t len) = 0; // Bytes taken, 0 if it would block, -1 if closed
+    virtual void close(int h) = 0;
+};
+
+#endif
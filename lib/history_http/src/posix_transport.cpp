@@ -0,0 +1,87 @@
+#ifndef ARDUINO_ARCH_ESP32
+
+#include <arpa/inet.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include "posix_transport.h"
+
+PosixTransport::PosixTransport(const char *bind_addr) : _bind_addr(bind_addr), _listen_fd(-1), _port(0)
+{
+}
+
+PosixTransport::~PosixTransport()
+{
+    if (_listen_fd >= 0)
+        ::close(_listen_fd);
+}
+
+bool PosixTransport::begin(uint16_t port)
+{
+    struct sockaddr_in addr = {};
+    socklen_t len = sizeof(addr);
+    int one = 1;
+
+    _listen_fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK, 0);
+    if (_listen_fd < 0)
+        return false;
+    setsockopt(_listen_fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    if (inet_pton(AF_INET, _bind_addr, &addr.sin_addr) != 1 ||
+        bind(_listen_fd, (struct sockaddr *)&addr, sizeof(addr)) < 0 || listen(_listen_fd, 64) < 0 ||
+        getsockname(_listen_fd, (struct sockaddr *)&addr, &len) < 0)
+    {
+        ::close(_listen_fd);
+        _listen_fd = -1;
+        return false;
+    }
+
+    _port = ntohs(addr.sin_port);
+    return true;
+}
+
+int PosixTransport::accept(void)
+{
+    int one = 1;
+
+    if (_listen_fd < 0)
+        return -1;
+
+    int fd = accept4(_listen_fd, NULL, NULL, SOCK_NONBLOCK);
+    if (fd < 0)
+        return -1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    return fd;
+}
+
+int PosixTransport::read(int h, uint8_t *buf, size_t len)
+{
+    ssize_t n = recv(h, buf, len, MSG_DONTWAIT);
+    if (n > 0)
+        return (int)n;
+    if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR))
+        return 0;
+    return -1;
+}
+
+int PosixTransport::write(int h, const uint8_t *buf, size_t len)
+{
+    ssize_t n = send(h, buf, len, MSG_DONTWAIT | MSG_NOSIGNAL);
+    if (n >= 0)
+        return (int)n;
+    if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)
+        return 0;
+    return -1;
+}
+
+void PosixTransport::close(int h)
+{
+    ::close(h);
+}
+
+#endif
@@ -0,0 +1,35 @@
+#ifndef POSIX_TRANSPORT_H
+#define POSIX_TRANSPORT_H
+
+//====================================================
+// posix_transport: NetTransport on non-blocking POSIX
+// sockets, handles are file descriptors. Binds to
+// loopback by default, port 0 picks a free port.
+//====================================================
+
+#ifndef ARDUINO_ARCH_ESP32
+
+#include "net_transport.h"
+
+class PosixTransport : public NetTransport
+{
+public:
+    PosixTransport(const char *bind_addr = "127.0.0.1");
+    ~PosixTransport();
+
+    bool begin(uint16_t port) override;
+    int accept(void) override;
+    int read(int h, uint8_t *buf, size_t len) override;
+    int write(int h, const uint8_t *buf, size_t len) override;
+    void close(int h) override;
+
+    uint16_t port(void) const { return _port; }
+
+private:
+    const char *_bind_addr;
+    int _listen_fd;
+    uint16_t _port;
+};
+
+#endif
+#endif
@@ -0,0 +1,72 @@
+#ifdef ARDUINO_ARCH_ESP32
+
+#include <errno.h>
+#include <lwip/sockets.h>
+#include "wifi_transport.h"
+
+WiFiTransport::WiFiTransport(const char *ssid, const char *password) : _ssid(ssid), _password(password)
+{
+    for (int i = 0; i < WIFI_TRANSPORT_CLIENTS; i++)
+        _used[i] = false;
+}
+
+bool WiFiTransport::begin(uint16_t port)
+{
+    if (_ssid == NULL || *_ssid == '\0')
+        return false;
+
+    // Connects in the background, the server answers once the station is up
+    WiFi.mode(WIFI_STA);
+    WiFi.begin(_ssid, _password);
+    _server.begin(port);
+    _server.setNoDelay(true);
+    return true;
+}
+
+int WiFiTransport::accept(void)
+{
+    for (int i = 0; i < WIFI_TRANSPORT_CLIENTS; i++)
+    {
+        if (_used[i])
+            continue;
+
+        WiFiClient client = _server.available();
+        if (!client)
+            return -1;
+        // Writes must not wait for a full TCP window, the loop serves everything else meanwhile
+        fcntl(client.fd(), F_SETFL, fcntl(client.fd(), F_GETFL, 0) | O_NONBLOCK);
+        _client[i] = client;
+        _used[i] = true;
+        return i;
+    }
+    return -1; // Table full, leave it in the backlog
+}
+
+int WiFiTransport::read(int h, uint8_t *buf, size_t len)
+{
+    int n = _client[h].available();
+    if (n > 0)
+        return _client[h].read(buf, (size_t)n < len ? (size_t)n : len);
+    return _client[h].connected() ? 0 : -1;
+}
+
+int WiFiTransport::write(int h, const uint8_t *buf, size_t len)
+{
+    if (!_client[h].connected())
+        return -1;
+    // Not WiFiClient::write(), it retries for up to 10 s while the peer's window is full
+    ssize_t n = send(_client[h].fd(), buf, len, MSG_DONTWAIT);
+    if (n >= 0)
+        return (int)n;
+    if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)
+        return 0;
+    return -1;
+}
+
+void WiFiTransport::close(int h)
+{
+    _client[h].stop();
+    _used[h] = false;
+}
+
+#endif
@@ -0,0 +1,41 @@
+#ifndef WIFI_TRANSPORT_H
+#define WIFI_TRANSPORT_H
+
+//====================================================
+// wifi_transport: NetTransport on the ESP32 WiFi
+// station, handles index a fixed table of WiFiClient.
+// Without an SSID begin() fails and the server stays
+// off. Client sockets are non-blocking, a write to a
+// full TCP window returns 0 and the server retries on
+// the next poll, as with PosixTransport.
+//====================================================
+
+#ifdef ARDUINO_ARCH_ESP32
+
+#include <WiFi.h>
+#include "net_transport.h"
+#include "history_http.h"
+
+#define WIFI_TRANSPORT_CLIENTS (HTTP_MAX_CLIENTS + 1) // One spare to answer 503
+
+class WiFiTransport : public NetTransport
+{
+public:
+    WiFiTransport(const char *ssid, const char *password);
+
+    bool begin(uint16_t port) override;
+    int accept(void) override;
+    int read(int h, uint8_t *buf, size_t len) override;
+    int write(int h, const uint8_t *buf, size_t len) override;
+    void close(int h) override;
+
+private:
+    const char *_ssid;
+    const char *_password;
+    WiFiServer _server;
+    WiFiClient _client[WIFI_TRANSPORT_CLIENTS];
+    bool _used[WIFI_TRANSPORT_CLIENTS];
+};
+
+#endif
+#endif
@@ -0,0 +1,253 @@
+#include "Adafruit_BMP280.h"
+#include "Wire.h"
+
+#define BMP280_STATUS_MEASURING 0x08
+#define BMP280_REGISTER_STATUS 0xF3
+
+// What the driver's compensation makes of the register addresses a failed read24() leaves in its buffer,
+// 0xFA0000 (temperature) and 0xF70000 (pressure), with the example calibration from the datasheet
+#define BMP280_ECHO_TEMPERATURE_C 180.14f
+#define BMP280_ECHO_PRESSURE_PA -1829.59f
+
+static float default_pressure_pa(uint32_t ms)
+{
+    // 18 hour swell of +-6 hPa around 995 hPa station pressure
+    return 99500.0f + 600.0f * (float)sin(2.0 * M_PI * (double)ms / (18.0 * 3600.0 * 1000.0));
+}
+
+static float default_temperature_c(uint32_t ms)
+{
+    (void)ms;
+    return 18.0f;
+}
+
+static host_trace_fn trace_pressure = default_pressure_pa;
+static host_trace_fn trace_temperature = default_temperature_c;
+static bool noise_enabled = true;
+static uint32_t device_allocations = 0;
+
+// Per address state, index 0 is 0x76 and 1 is 0x77
+static float sensor_bias[2] = {0.0f, 0.0f};
+static float glitch_probability[2] = {0.0f, 0.0f};
+static float glitch_pa[2] = {0.0f, 0.0f};
+
+static int slot(uint8_t addr)
+{
+    if (addr == BMP280_ADDRESS_ALT)
+        return 0;
+    if (addr == BMP280_ADDRESS)
+        return 1;
+    return -1;
+}
+
+static uint32_t oversampling(uint8_t code)
+{
+    return code ? 1u << (code - 1) : 0;
+}
+
+bool Adafruit_BMP280::begin(uint8_t addr, uint8_t chipid)
+{
+    int s = slot(addr);
+
+    device_allocations++;
+    Wire.begin(); // As Adafruit_I2CDevice::begin()
+    if (s < 0 || chipid != BMP280_CHIPID || !Wire.hostTransfer(addr))
+        return false;
+
+    _addr = addr;
+    _rng = 0x9E3779B9u * addr;
+    _mode = MODE_SLEEP;
+    _converting = false;
+    _filter_primed = false;
+    _pressure = _temperature = NAN;
+    return true;
+}
+
+//====================================================
+// reset: Soft reset, the sensor goes back to sleep with
+// its power-on settings. The calibration read by
+// begin() stays valid.
+//====================================================
+void Adafruit_BMP280::reset(void)
+{
+    update();
+    if (!Wire.hostTransfer(_addr))
+        return;
+
+    _mode = MODE_SLEEP;
+    _osrs_t = _osrs_p = SAMPLING_NONE;
+    _filter = FILTER_OFF;
+    _standby = STANDBY_MS_1;
+    _converting = false;
+    _filter_primed = false;
+}
+
+void Adafruit_BMP280::setSampling(sensor_mode mode, sensor_sampling tempSampling, sensor_sampling pressSampling,
+                                  sensor_filter filter, standby_duration duration)
+{
+    update();
+    if (!Wire.hostTransfer(_addr))
+        return; // Control register not written, nothing changes
+
+    _mode = mode;
+    _osrs_t = tempSampling;
+    _osrs_p = pressSampling;
+    _filter = filter;
+    _standby = duration;
+
+    // Writing the control register in forced mode starts one conversion
+    if (mode == MODE_FORCED)
+    {
+        _converting = true;
+        _conv_start_us = micros();
+    }
+    if (mode == MODE_NORMAL)
+    {
+        convert();
+        _cycle_us = micros();
+    }
+}
+
+uint8_t Adafruit_BMP280::getStatus(void)
+{
+    update();
+    if (!Wire.hostTransfer(_addr))
+        return BMP280_REGISTER_STATUS; // read8() leaves the register address in its buffer on a failed read
+    if (_mode == MODE_FORCED && _converting)
+        return BMP280_STATUS_MEASURING;
+    if (_mode == MODE_NORMAL && micros() - _cycle_us < measureUs())
+        return BMP280_STATUS_MEASURING;
+    return 0;
+}
+
+//====================================================
+// readTemperature, readPressure: As the real library,
+// a failed read is not reported, it returns what the
+// register address left in the buffer compensates to.
+//====================================================
+float Adafruit_BMP280::readTemperature(void)
+{
+    update();
+    return Wire.hostTransfer(_addr) ? _temperature : BMP280_ECHO_TEMPERATURE_C;
+}
+
+float Adafruit_BMP280::readPressure(void)
+{
+    update();
+    return Wire.hostTransfer(_addr) ? _pressure : BMP280_ECHO_PRESSURE_PA;
+}
+
+//====================================================
+// measureUs: Typical t_measure from the datasheet,
+// 1 ms + 2 ms per temperature and pressure oversample
+// + 0.5 ms pressure setup.
+//====================================================
+uint32_t Adafruit_BMP280::measureUs(void) const
+{
+    uint32_t os_p = oversampling(_osrs_p);
+    return 1000 + 2000 * oversampling(_osrs_t) + 2000 * os_p + (os_p ? 500 : 0);
+}
+
+uint32_t Adafruit_BMP280::standbyUs(void) const
+{
+    static const uint32_t standby_us[8] = {500, 62500, 125000, 250000, 500000, 1000000, 2000000, 4000000};
+    return standby_us[_standby & 7];
+}
+
+void Adafruit_BMP280::update(void)
+{
+    if (_mode == MODE_FORCED && _converting && micros() - _conv_start_us >= measureUs())
+    {
+        convert();
+        _converting = false;
+        _mode = MODE_SLEEP; // Back to sleep after a forced conversion
+    }
+
+    if (_mode == MODE_NORMAL)
+    {
+        uint32_t cycle = measureUs() + standbyUs();
+        uint32_t elapsed = micros() - _cycle_us;
+        if (elapsed > 64 * cycle)
+        {
+            // Long gap, the IIR filter has settled on the trace anyway
+            _cycle_us += elapsed - 64 * cycle;
+            elapsed = 64 * cycle;
+        }
+        while (elapsed >= cycle)
+        {
+            convert();
+            _cycle_us += cycle;
+            elapsed -= cycle;
+        }
+    }
+}
+
+void Adafruit_BMP280::convert(void)
+{
+    int s = slot(_addr);
+    uint32_t os_p = oversampling(_osrs_p);
+    float x = trace_pressure(millis()) + sensor_bias[s];
+    float t = trace_temperature(millis());
+
+    if (noise_enabled)
+    {
+        x += gauss() * 3.0f / sqrtf(os_p ? (float)os_p : 1.0f);
+        t += gauss() * 0.01f;
+    }
+    if (glitch_probability[s] > 0.0f && (_rng = _rng * 1664525u + 1013904223u) < glitch_probability[s] * 4294967295.0f)
+        x += glitch_pa[s];
+
+    if (_filter == FILTER_OFF || !_filter_primed)
+        _pressure = x;
+    else
+        _pressure += (x - _pressure) / (float)(1 << _filter);
+    _filter_primed = true;
+    _temperature = t;
+}
+
+float Adafruit_BMP280::gauss(void)
+{
+    // Box-Muller on a per sensor LCG, runs are repeatable
+    _rng = _rng * 1664525u + 1013904223u;
+    float u1 = ((_rng >> 8) + 1.0f) / 16777217.0f;
+    _rng = _rng * 1664525u + 1013904223u;
+    float u2 = (_rng >> 8) / 16777216.0f;
+    return sqrtf(-2.0f * logf(u1)) * cosf(2.0f * (float)M_PI * u2);
+}
+
+void Adafruit_BMP280::setTrace(host_trace_fn pressure_pa, host_trace_fn temperature_c)
+{
+    trace_pressure = pressure_pa ? pressure_pa : default_pressure_pa;
+    trace_temperature = temperature_c ? temperature_c : default_temperature_c;
+}
+
+void Adafruit_BMP280::setNoise(bool enabled)
+{
+    noise_enabled = enabled;
+}
+
+void Adafruit_BMP280::setPresent(uint8_t addr, bool present)
+{
+    if (slot(addr) >= 0)
+        Wire.setPresent(addr, present);
+}
+
+uint32_t Adafruit_BMP280::allocations(void)
+{
+    return device_allocations;
+}
+
+void Adafruit_BMP280::setBias(uint8_t addr, float pressure_pa)
+{
+    if (slot(addr) >= 0)
+        sensor_bias[slot(addr)] = pressure_pa;
+}
+
+void Adafruit_BMP280::setGlitch(uint8_t addr, float probability, float pressure_pa)
+{
+    if (slot(addr) >= 0)
+    {
+        glitch_probability[slot(addr)] = probability;
+        glitch_pa[slot(addr)] = pressure_pa;
+    }
+}
@@ -0,0 +1,114 @@
+#ifndef HOST_EMULATOR_ADAFRUIT_BMP280_H
+#define HOST_EMULATOR_ADAFRUIT_BMP280_H
+
+//====================================================
+// Adafruit_BMP280 (host): Fake BMP280 returning station
+// pressure and temperature from a trace function of the
+// virtual clock. The default trace is a slow swell
+// around 995 hPa, replace it with setTrace().
+//
+// Each address is an independent sensor with its own
+// bias, noise and glitches. Conversion time follows the
+// datasheet typical t_measure, pressure noise is modelled
+// as 3 Pa rms / sqrt(oversampling). In normal mode the
+// IIR filter runs once per conversion + standby cycle,
+// so the filter lag is there as on the real part.
+//
+// Register accesses go over the Wire fake, so faults
+// injected there hit the sensors as on a real bus.
+//====================================================
+
+#include "Arduino.h"
+
+#define BMP280_ADDRESS (0x77)
+#define BMP280_ADDRESS_ALT (0x76)
+#define BMP280_CHIPID (0x58)
+
+typedef float (*host_trace_fn)(uint32_t ms);
+
+class Adafruit_BMP280
+{
+public:
+    enum sensor_sampling
+    {
+        SAMPLING_NONE = 0x00,
+        SAMPLING_X1 = 0x01,
+        SAMPLING_X2 = 0x02,
+        SAMPLING_X4 = 0x03,
+        SAMPLING_X8 = 0x04,
+        SAMPLING_X16 = 0x05
+    };
+
+    enum sensor_mode
+    {
+        MODE_SLEEP = 0x00,
+        MODE_FORCED = 0x01,
+        MODE_NORMAL = 0x03,
+        MODE_SOFT_RESET_CODE = 0xB6
+    };
+
+    enum sensor_filter
+    {
+        FILTER_OFF = 0x00,
+        FILTER_X2 = 0x01,
+        FILTER_X4 = 0x02,
+        FILTER_X8 = 0x03,
+        FILTER_X16 = 0x04
+    };
+
+    enum standby_duration
+    {
+        STANDBY_MS_1 = 0x00,
+        STANDBY_MS_63 = 0x01,
+        STANDBY_MS_125 = 0x02,
+        STANDBY_MS_250 = 0x03,
+        STANDBY_MS_500 = 0x04,
+        STANDBY_MS_1000 = 0x05,
+        STANDBY_MS_2000 = 0x06,
+        STANDBY_MS_4000 = 0x07
+    };
+
+    bool begin(uint8_t addr = BMP280_ADDRESS, uint8_t chipid = BMP280_CHIPID);
+    void reset(void);
+    void setSampling(sensor_mode mode = MODE_NORMAL,
+                     sensor_sampling tempSampling = SAMPLING_X16,
+                     sensor_sampling pressSampling = SAMPLING_X16,
+                     sensor_filter filter = FILTER_OFF,
+                     standby_duration duration = STANDBY_MS_1);
+    uint8_t getStatus(void);
+    float readTemperature(void);
+    float readPressure(void);
+
+    // Host only, apply to every fake sensor
+    static void setTrace(host_trace_fn pressure_pa, host_trace_fn temperature_c);
+    static void setNoise(bool enabled);
+    static uint32_t allocations(void); // begin() calls, the real one news an Adafruit_I2CDevice every time
+
+    // Host only, per I2C address 0x76/0x77
+    static void setPresent(uint8_t addr, bool present);
+    static void setBias(uint8_t addr, float pressure_pa);
+    static void setGlitch(uint8_t addr, float probability, float pressure_pa);
+
+private:
+    uint32_t measureUs(void) const;
+    uint32_t standbyUs(void) const;
+    void convert(void);
+    void update(void);
+    float gauss(void);
+
+    uint8_t _addr = 0;
+    sensor_mode _mode = MODE_SLEEP;
+    sensor_sampling _osrs_t = SAMPLING_X1;
+    sensor_sampling _osrs_p = SAMPLING_X1;
+    sensor_filter _filter = FILTER_OFF;
+    standby_duration _standby = STANDBY_MS_1;
+
+    uint32_t _conv_start_us = 0;
+    bool _converting = false;
+    uint32_t _cycle_us = 0;
+    float _pressure = 0.0f, _temperature = 0.0f;
+    bool _filter_primed = false;
+    uint32_t _rng = 1;
+};
+
+#endif
@@ -0,0 +1,170 @@
+#include <stdarg.h>
+#include "Arduino.h"
+
+HardwareSerial Serial;
+
+static uint64_t host_clock_us = 0;
+
+uint32_t millis(void)
+{
+    return (uint32_t)(host_clock_us / 1000);
+}
+
+uint32_t micros(void)
+{
+    return (uint32_t)host_clock_us;
+}
+
+void delay(uint32_t ms)
+{
+    host_advance_ms(ms);
+}
+
+void delayMicroseconds(uint32_t us)
+{
+    host_advance_us(us);
+}
+
+void host_advance_ms(uint32_t ms)
+{
+    host_clock_us += (uint64_t)ms * 1000;
+}
+
+void host_advance_us(uint32_t us)
+{
+    host_clock_us += us;
+}
+
+//====================================================
+// GPIO
+//====================================================
+
+#define HOST_PINS 40
+
+static uint8_t pin_mode[HOST_PINS];
+static uint8_t pin_level[HOST_PINS];
+static host_pin_read_fn pin_read_hook = NULL;
+static host_pin_write_fn pin_write_hook = NULL;
+
+void pinMode(uint8_t pin, uint8_t mode)
+{
+    if (pin >= HOST_PINS)
+        return;
+    pin_mode[pin] = mode;
+    pin_level[pin] = HIGH; // ESP32 drives/releases high after a mode change
+    if (pin_write_hook && (mode & OUTPUT) == OUTPUT)
+        pin_write_hook(pin, HIGH);
+}
+
+void digitalWrite(uint8_t pin, uint8_t val)
+{
+    if (pin >= HOST_PINS)
+        return;
+    pin_level[pin] = val ? HIGH : LOW;
+    if (pin_write_hook && (pin_mode[pin] & OUTPUT) == OUTPUT)
+        pin_write_hook(pin, pin_level[pin]);
+}
+
+int digitalRead(uint8_t pin)
+{
+    if (pin >= HOST_PINS)
+        return LOW;
+
+    // Inputs float high on the pull-up, outputs read back what they drive
+    int level = (pin_mode[pin] & OUTPUT) == OUTPUT ? pin_level[pin] : HIGH;
+    return pin_read_hook ? pin_read_hook(pin, level) : level;
+}
+
+void host_pin_hooks(host_pin_read_fn read, host_pin_write_fn write)
+{
+    pin_read_hook = read;
+    pin_write_hook = write;
+}
+
+long map(long x, long in_min, long in_max, long out_min, long out_max)
+{
+    return (x - in_min) * (out_max - out_min) / (in_max - in_min) + out_min;
+}
+
+char *dtostrf(double val, signed char width, unsigned char prec, char *sout)
+{
+    sprintf(sout, "%*.*f", width, prec, val);
+    return sout;
+}
+
+//====================================================
+// HardwareSerial
+//====================================================
+
+size_t HardwareSerial::print(const char *s)
+{
+    return printf("%s", s);
+}
+
+size_t HardwareSerial::print(char c)
+{
+    return printf("%c", c);
+}
+
+size_t HardwareSerial::print(int n)
+{
+    return printf("%d", n);
+}
+
+size_t HardwareSerial::print(unsigned int n)
+{
+    return printf("%u", n);
+}
+
+size_t HardwareSerial::print(long n)
+{
+    return printf("%ld", n);
+}
+
+size_t HardwareSerial::print(unsigned long n)
+{
+    return printf("%lu", n);
+}
+
+size_t HardwareSerial::print(double n, int digits)
+{
+    return printf("%.*f", digits, n);
+}
+
+size_t HardwareSerial::println(void)
+{
+    return print("\r\n");
+}
+
+size_t HardwareSerial::println(const char *s)
+{
+    return print(s) + println();
+}
+
+size_t HardwareSerial::println(int n)
+{
+    return print(n) + println();
+}
+
+size_t HardwareSerial::println(long n)
+{
+    return print(n) + println();
+}
+
+size_t HardwareSerial::println(double n, int digits)
+{
+    return print(n, digits) + println();
+}
+
+size_t HardwareSerial::printf(const char *format, ...)
+{
+    if (_out == NULL)
+        return 0;
+
+    va_list args;
+    va_start(args, format);
+    int n = vfprintf(_out, format, args);
+    va_end(args);
+
+    return n < 0 ? 0 : (size_t)n;
+}
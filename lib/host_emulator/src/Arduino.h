@@ -0,0 +1,95 @@
+#ifndef HOST_EMULATOR_ARDUINO_H
+#define HOST_EMULATOR_ARDUINO_H
+
+//====================================================
+// Arduino.h (host): The small part of the Arduino core
+// the barometer firmware uses, so 'src/main.cpp' can be
+// compiled and run on a PC. Time is virtual, delay()
+// advances the clock instead of sleeping.
+//====================================================
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <algorithm>
+
+typedef uint8_t byte;
+
+using std::max; // As the ESP32 core
+using std::min;
+
+#define F(string_literal) (string_literal)
+
+//====================================================
+// Virtual clock
+//====================================================
+
+uint32_t millis(void);
+uint32_t micros(void);
+void delay(uint32_t ms);
+void delayMicroseconds(uint32_t us);
+void host_advance_ms(uint32_t ms);
+void host_advance_us(uint32_t us);
+
+//====================================================
+// GPIO: Pin levels for open-drain lines such as I2C.
+// An input reads high (pull-up) unless the pin drives
+// low or a host fake pulls the line low, see the Wire
+// fake. Mode values as in the ESP32 core.
+//====================================================
+
+#define LOW 0x0
+#define HIGH 0x1
+#define INPUT 0x01
+#define OUTPUT 0x03
+#define INPUT_PULLUP 0x05
+#define OUTPUT_OPEN_DRAIN 0x13
+
+#define SDA 21 // ESP32 default I2C pins
+#define SCL 22
+
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t val);
+int digitalRead(uint8_t pin);
+
+typedef int (*host_pin_read_fn)(uint8_t pin, int level); // Returns the line level seen on the pin
+typedef void (*host_pin_write_fn)(uint8_t pin, uint8_t level);
+void host_pin_hooks(host_pin_read_fn read, host_pin_write_fn write);
+
+long map(long x, long in_min, long in_max, long out_min, long out_max);
+char *dtostrf(double val, signed char width, unsigned char prec, char *sout);
+
+//====================================================
+// HardwareSerial: Writes to a host stream, stdout by
+// default. A NULL stream silences the serial port.
+//====================================================
+class HardwareSerial
+{
+public:
+    void begin(unsigned long baud) { (void)baud; }
+    void setOutput(FILE *stream) { _out = stream; }
+    operator bool() const { return true; }
+
+    size_t print(const char *s);
+    size_t print(char c);
+    size_t print(int n);
+    size_t print(unsigned int n);
+    size_t print(long n);
+    size_t print(unsigned long n);
+    size_t print(double n, int digits = 2);
+    size_t println(void);
+    size_t println(const char *s);
+    size_t println(int n);
+    size_t println(long n);
+    size_t println(double n, int digits = 2);
+    size_t printf(const char *format, ...) __attribute__((format(printf, 2, 3)));
+
+private:
+    FILE *_out = stdout;
+};
+
+extern HardwareSerial Serial;
+
+#endif
@@ -0,0 +1,52 @@
+#ifndef HOST_EMULATOR_ESP32TIME_H
+#define HOST_EMULATOR_ESP32TIME_H
+
+//====================================================
+// ESP32Time (host): RTC driven by the virtual clock in
+// Arduino.cpp, same 12h getHour() default as the
+// real fbiego/ESP32Time library.
+//====================================================
+
+#include <time.h>
+#include "Arduino.h"
+
+class ESP32Time
+{
+public:
+    void setTime(int sc, int mn, int hr, int dy, int mt, int yr)
+    {
+        struct tm t = {};
+        t.tm_sec = sc;
+        t.tm_min = mn;
+        t.tm_hour = hr;
+        t.tm_mday = dy;
+        t.tm_mon = mt - 1;
+        t.tm_year = yr - 1900;
+        _epoch = timegm(&t);
+        _set_at_ms = millis();
+    }
+
+    int getSecond(void) { return now().tm_sec; }
+    int getMinute(void) { return now().tm_min; }
+    int getHour(bool mode = false)
+    {
+        int hour = now().tm_hour;
+        if (!mode && hour > 12)
+            hour -= 12;
+        return hour;
+    }
+
+private:
+    struct tm now(void)
+    {
+        time_t t = _epoch + (time_t)((millis() - _set_at_ms) / 1000);
+        struct tm out;
+        gmtime_r(&t, &out);
+        return out;
+    }
+
+    time_t _epoch = 0;
+    uint32_t _set_at_ms = 0;
+};
+
+#endif
@@ -0,0 +1,6 @@
+#ifndef HOST_EMULATOR_SPI_H
+#define HOST_EMULATOR_SPI_H
+
+// SPI traffic is modelled inside the TFT_eSPI emulator, nothing to do here.
+
+#endif
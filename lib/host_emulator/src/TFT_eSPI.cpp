@@ -0,0 +1,616 @@
+#include "TFT_eSPI.h"
+
+const GFXfont FreeSans12pt7b = {"FreeSans12pt7b", 13, 29, 4};
+const GFXfont Orbitron_Light_24 = {"Orbitron_Light_24", 17, 31, 4};
+
+//====================================================
+// 3x5 glyphs, one row per byte, bit 2 is the left column
+//====================================================
+static const uint8_t glyph_digit[10][5] = {
+    {7, 5, 5, 5, 7}, {2, 6, 2, 2, 7}, {7, 1, 7, 4, 7}, {7, 1, 7, 1, 7}, {5, 5, 7, 1, 1},
+    {7, 4, 7, 1, 7}, {7, 4, 7, 5, 7}, {7, 1, 1, 1, 1}, {7, 5, 7, 5, 7}, {7, 5, 7, 1, 7}};
+
+static const uint8_t glyph_alpha[26][5] = {
+    {2, 5, 7, 5, 5}, {6, 5, 6, 5, 6}, {3, 4, 4, 4, 3}, {6, 5, 5, 5, 6}, {7, 4, 6, 4, 7},
+    {7, 4, 6, 4, 4}, {3, 4, 5, 5, 3}, {5, 5, 7, 5, 5}, {7, 2, 2, 2, 7}, {1, 1, 1, 5, 2},
+    {5, 5, 6, 5, 5}, {4, 4, 4, 4, 7}, {5, 7, 7, 5, 5}, {6, 5, 5, 5, 5}, {2, 5, 5, 5, 2},
+    {6, 5, 6, 4, 4}, {2, 5, 5, 6, 3}, {6, 5, 6, 5, 5}, {3, 4, 2, 1, 6}, {7, 2, 2, 2, 2},
+    {5, 5, 5, 5, 7}, {5, 5, 5, 5, 2}, {5, 5, 7, 7, 5}, {5, 5, 2, 5, 5}, {5, 5, 2, 2, 2},
+    {7, 1, 2, 4, 7}};
+
+static const uint8_t *glyph_rows(char c)
+{
+    static const uint8_t space[5] = {0, 0, 0, 0, 0};
+    static const uint8_t percent[5] = {5, 1, 2, 4, 5};
+    static const uint8_t plus[5] = {0, 2, 7, 2, 0};
+    static const uint8_t minus[5] = {0, 0, 7, 0, 0};
+    static const uint8_t dot[5] = {0, 0, 0, 0, 2};
+    static const uint8_t colon[5] = {0, 2, 0, 2, 0};
+    static const uint8_t slash[5] = {1, 1, 2, 4, 4};
+    static const uint8_t unknown[5] = {7, 1, 2, 0, 2};
+
+    if (c >= '0' && c <= '9')
+        return glyph_digit[c - '0'];
+    if (c >= 'A' && c <= 'Z')
+        return glyph_alpha[c - 'A'];
+    if (c >= 'a' && c <= 'z')
+        return glyph_alpha[c - 'a'];
+
+    switch (c)
+    {
+    case ' ':
+        return space;
+    case '%':
+        return percent;
+    case '+':
+        return plus;
+    case '-':
+        return minus;
+    case '.':
+        return dot;
+    case ':':
+        return colon;
+    case '/':
+        return slash;
+    }
+    return unknown;
+}
+
+//====================================================
+// tft_prim_scope: Attributes all bus traffic to the
+// outermost public primitive, e.g. the four fast lines
+// of drawRect() count as one RECT call.
+//====================================================
+struct tft_prim_scope
+{
+    TFT_eSPI *tft;
+
+    tft_prim_scope(TFT_eSPI *t, int prim) : tft(t)
+    {
+        if (tft->_depth++ == 0)
+        {
+            tft->_prim = prim;
+            tft->_stats.prim[prim].calls++;
+        }
+    }
+    ~tft_prim_scope() { tft->_depth--; }
+};
+
+TFT_eSPI::TFT_eSPI(int16_t w, int16_t h) : _width(w), _height(h)
+{
+    _fb = (uint16_t *)calloc((size_t)w * h, sizeof(uint16_t));
+    _fb_prev = (uint16_t *)calloc((size_t)w * h, sizeof(uint16_t));
+    _heat = (uint16_t *)calloc((size_t)w * h, sizeof(uint16_t));
+    memset(&_stats, 0, sizeof(_stats));
+}
+
+TFT_eSPI::~TFT_eSPI()
+{
+    free(_fb);
+    free(_fb_prev);
+    free(_heat);
+}
+
+void TFT_eSPI::init(void)
+{
+    memset(_fb, 0, (size_t)_width * _height * sizeof(uint16_t));
+}
+
+void TFT_eSPI::setRotation(uint8_t r)
+{
+    // Framebuffer is allocated portrait, landscape only swaps the axes
+    if ((r & 1) != (_width > _height))
+    {
+        int16_t t = _width;
+        _width = _height;
+        _height = t;
+    }
+}
+
+//====================================================
+// Bus model
+//====================================================
+
+void TFT_eSPI::window(int32_t x0, int32_t y0, int32_t x1, int32_t y1)
+{
+    (void)x0;
+    (void)y0;
+    (void)x1;
+    (void)y1;
+    _stats.windows++;
+    _stats.bytes += TFT_EMU_WINDOW_BYTES;
+    _stats.prim[_prim].windows++;
+    _stats.prim[_prim].bytes += TFT_EMU_WINDOW_BYTES;
+}
+
+void TFT_eSPI::push(int32_t x, int32_t y, uint16_t color)
+{
+    uint32_t i = (uint32_t)y * _width + x;
+
+    _fb[i] = color;
+    if (_heat[i] < UINT16_MAX)
+        _heat[i]++;
+
+    _stats.pixels++;
+    _stats.bytes += TFT_EMU_PIXEL_BYTES;
+    _stats.prim[_prim].pixels++;
+    _stats.prim[_prim].bytes += TFT_EMU_PIXEL_BYTES;
+}
+
+void TFT_eSPI::block(int32_t x, int32_t y, int32_t w, int32_t h, uint16_t color)
+{
+    // Clip, TFT_eSPI never sends pixels outside the screen
+    if (x < 0)
+    {
+        w += x;
+        x = 0;
+    }
+    if (y < 0)
+    {
+        h += y;
+        y = 0;
+    }
+    if (x + w > _width)
+        w = _width - x;
+    if (y + h > _height)
+        h = _height - y;
+    if (w < 1 || h < 1)
+        return;
+
+    window(x, y, x + w - 1, y + h - 1);
+    for (int32_t yy = y; yy < y + h; yy++)
+        for (int32_t xx = x; xx < x + w; xx++)
+            push(xx, yy, color);
+}
+
+//====================================================
+// Graphics primitives
+//====================================================
+
+void TFT_eSPI::fillScreen(uint32_t color)
+{
+    fillRect(0, 0, _width, _height, color);
+}
+
+void TFT_eSPI::drawPixel(int32_t x, int32_t y, uint32_t color)
+{
+    tft_prim_scope scope(this, TFT_PRIM_PIXEL);
+    block(x, y, 1, 1, color);
+}
+
+void TFT_eSPI::drawFastHLine(int32_t x, int32_t y, int32_t w, uint32_t color)
+{
+    tft_prim_scope scope(this, TFT_PRIM_HLINE);
+    block(x, y, w, 1, color);
+}
+
+void TFT_eSPI::drawFastVLine(int32_t x, int32_t y, int32_t h, uint32_t color)
+{
+    tft_prim_scope scope(this, TFT_PRIM_VLINE);
+    block(x, y, 1, h, color);
+}
+
+void TFT_eSPI::drawLine(int32_t x0, int32_t y0, int32_t x1, int32_t y1, uint32_t color)
+{
+    tft_prim_scope scope(this, TFT_PRIM_LINE);
+
+    // Same run splitting as TFT_eSPI::drawLine()
+    bool steep = abs(y1 - y0) > abs(x1 - x0);
+    int32_t t;
+    if (steep)
+    {
+        t = x0, x0 = y0, y0 = t;
+        t = x1, x1 = y1, y1 = t;
+    }
+    if (x0 > x1)
+    {
+        t = x0, x0 = x1, x1 = t;
+        t = y0, y0 = y1, y1 = t;
+    }
+
+    int32_t dx = x1 - x0, dy = abs(y1 - y0);
+    int32_t err = dx >> 1, ystep = (y0 < y1) ? 1 : -1, xs = x0, dlen = 0;
+
+    for (; x0 <= x1; x0++)
+    {
+        dlen++;
+        err -= dy;
+        if (err < 0)
+        {
+            if (steep)
+                block(y0, xs, 1, dlen, color);
+            else
+                block(xs, y0, dlen, 1, color);
+            dlen = 0;
+            y0 += ystep;
+            xs = x0 + 1;
+            err += dx;
+        }
+    }
+    if (dlen)
+    {
+        if (steep)
+            block(y0, xs, 1, dlen, color);
+        else
+            block(xs, y0, dlen, 1, color);
+    }
+}
+
+void TFT_eSPI::drawRect(int32_t x, int32_t y, int32_t w, int32_t h, uint32_t color)
+{
+    tft_prim_scope scope(this, TFT_PRIM_RECT);
+    drawFastHLine(x, y, w, color);
+    drawFastHLine(x, y + h - 1, w, color);
+    drawFastVLine(x, y + 1, h - 2, color);
+    drawFastVLine(x + w - 1, y + 1, h - 2, color);
+}
+
+void TFT_eSPI::fillRect(int32_t x, int32_t y, int32_t w, int32_t h, uint32_t color)
+{
+    tft_prim_scope scope(this, TFT_PRIM_FILLRECT);
+    block(x, y, w, h, color);
+}
+
+void TFT_eSPI::fillTriangle(int32_t x0, int32_t y0, int32_t x1, int32_t y1, int32_t x2, int32_t y2, uint32_t color)
+{
+    tft_prim_scope scope(this, TFT_PRIM_TRIANGLE);
+
+    int32_t a, b, y, last, t;
+
+    // Sort coordinates by Y order (y2 >= y1 >= y0)
+    if (y0 > y1)
+    {
+        t = y0, y0 = y1, y1 = t;
+        t = x0, x0 = x1, x1 = t;
+    }
+    if (y1 > y2)
+    {
+        t = y2, y2 = y1, y1 = t;
+        t = x2, x2 = x1, x1 = t;
+    }
+    if (y0 > y1)
+    {
+        t = y0, y0 = y1, y1 = t;
+        t = x0, x0 = x1, x1 = t;
+    }
+
+    if (y0 == y2)
+    {
+        a = b = x0;
+        if (x1 < a)
+            a = x1;
+        else if (x1 > b)
+            b = x1;
+        if (x2 < a)
+            a = x2;
+        else if (x2 > b)
+            b = x2;
+        drawFastHLine(a, y0, b - a + 1, color);
+        return;
+    }
+
+    int32_t dx01 = x1 - x0, dy01 = y1 - y0, dx02 = x2 - x0, dy02 = y2 - y0, dx12 = x2 - x1, dy12 = y2 - y1;
+    int32_t sa = 0, sb = 0;
+
+    last = (y1 == y2) ? y1 : y1 - 1;
+
+    for (y = y0; y <= last; y++)
+    {
+        a = x0 + sa / dy01;
+        b = x0 + sb / dy02;
+        sa += dx01;
+        sb += dx02;
+        if (a > b)
+            t = a, a = b, b = t;
+        drawFastHLine(a, y, b - a + 1, color);
+    }
+
+    sa = dx12 * (y - y1);
+    sb = dx02 * (y - y0);
+    for (; y <= y2; y++)
+    {
+        a = x1 + sa / dy12;
+        b = x0 + sb / dy02;
+        sa += dx12;
+        sb += dx02;
+        if (a > b)
+            t = a, a = b, b = t;
+        drawFastHLine(a, y, b - a + 1, color);
+    }
+}
+
+//====================================================
+// Text
+//====================================================
+
+void TFT_eSPI::setTextColor(uint16_t color)
+{
+    _textcolor = _textbgcolor = color;
+}
+
+void TFT_eSPI::setTextColor(uint16_t fgcolor, uint16_t bgcolor, bool bgfill)
+{
+    (void)bgfill;
+    _textcolor = fgcolor;
+    _textbgcolor = bgcolor;
+}
+
+void TFT_eSPI::setFreeFont(const GFXfont *f)
+{
+    _textfont = 1;
+    _gfxFont = f;
+}
+
+TFT_eSPI::font_metrics TFT_eSPI::metrics(uint8_t font) const
+{
+    if (font == 1 && _gfxFont)
+        return {_gfxFont->xAdvance, _gfxFont->yAdvance, _gfxFont->scale};
+
+    switch (font)
+    {
+    case 2:
+        return {8, 16, 2};
+    case 4:
+        return {14, 26, 4};
+    case 6:
+        return {27, 48, 8};
+    case 7:
+        return {32, 48, 9};
+    case 8:
+        return {55, 75, 14};
+    }
+    return {6, 8, 1};
+}
+
+int16_t TFT_eSPI::textWidth(const char *string, uint8_t font)
+{
+    return (int16_t)(strlen(string) * metrics(font).advance);
+}
+
+int16_t TFT_eSPI::fontHeight(uint8_t font)
+{
+    return metrics(font).height;
+}
+
+void TFT_eSPI::drawGlyph(char c, int32_t x, int32_t y, const font_metrics &m)
+{
+    const uint8_t *rows = glyph_rows(c);
+    int32_t gx = x + (m.advance - 3 * m.scale) / 2;
+    int32_t gy = y + (m.height - 5 * m.scale) / 2;
+
+    if (_textcolor != _textbgcolor)
+    {
+        // Background colour set, the whole cell goes out in one window
+        int32_t x0 = x < 0 ? 0 : x, y0 = y < 0 ? 0 : y;
+        int32_t x1 = x + m.advance - 1, y1 = y + m.height - 1;
+        if (x1 >= _width)
+            x1 = _width - 1;
+        if (y1 >= _height)
+            y1 = _height - 1;
+        if (x1 < x0 || y1 < y0)
+            return;
+
+        window(x0, y0, x1, y1);
+        for (int32_t yy = y0; yy <= y1; yy++)
+        {
+            for (int32_t xx = x0; xx <= x1; xx++)
+            {
+                int32_t col = (xx - gx) / m.scale, row = (yy - gy) / m.scale;
+                bool lit = xx >= gx && yy >= gy && col < 3 && row < 5 && (rows[row] & (4 >> col));
+                push(xx, yy, lit ? _textcolor : _textbgcolor);
+            }
+        }
+        return;
+    }
+
+    // Transparent text, one window per horizontal run of lit pixels
+    for (int row = 0; row < 5; row++)
+    {
+        for (int col = 0; col < 3;)
+        {
+            if (!(rows[row] & (4 >> col)))
+            {
+                col++;
+                continue;
+            }
+            int run = 0;
+            while (col + run < 3 && (rows[row] & (4 >> (col + run))))
+                run++;
+            for (int s = 0; s < m.scale; s++)
+                block(gx + col * m.scale, gy + row * m.scale + s, run * m.scale, 1, _textcolor);
+            col += run;
+        }
+    }
+}
+
+int16_t TFT_eSPI::drawString(const char *string, int32_t x, int32_t y, uint8_t font)
+{
+    tft_prim_scope scope(this, TFT_PRIM_TEXT);
+
+    font_metrics m = metrics(font);
+    int32_t cwidth = textWidth(string, font);
+    int32_t cheight = m.height;
+
+    switch (_textdatum)
+    {
+    case TC_DATUM:
+    case MC_DATUM:
+    case BC_DATUM:
+        x -= cwidth / 2;
+        break;
+    case TR_DATUM:
+    case MR_DATUM:
+    case BR_DATUM:
+        x -= cwidth;
+        break;
+    }
+    switch (_textdatum)
+    {
+    case ML_DATUM:
+    case MC_DATUM:
+    case MR_DATUM:
+        y -= cheight / 2;
+        break;
+    case BL_DATUM:
+    case BC_DATUM:
+    case BR_DATUM:
+        y -= cheight;
+        break;
+    }
+
+    for (const char *c = string; *c; c++)
+        drawGlyph(*c, x + (int32_t)(c - string) * m.advance, y, m);
+
+    // Pad with background colour like TFT_eSPI does, depending on datum
+    if (_padX > cwidth && _textcolor != _textbgcolor)
+    {
+        int32_t pad = _padX - cwidth;
+        _prim = TFT_PRIM_PADDING;
+        _stats.prim[TFT_PRIM_PADDING].calls++;
+        switch (_textdatum)
+        {
+        case TC_DATUM:
+        case MC_DATUM:
+        case BC_DATUM:
+            block(x - pad / 2, y, pad / 2, cheight, _textbgcolor);
+            block(x + cwidth, y, pad - pad / 2, cheight, _textbgcolor);
+            break;
+        case TR_DATUM:
+        case MR_DATUM:
+        case BR_DATUM:
+            block(x - pad, y, pad, cheight, _textbgcolor);
+            break;
+        default:
+            block(x + cwidth, y, pad, cheight, _textbgcolor);
+            break;
+        }
+        _prim = TFT_PRIM_TEXT;
+    }
+
+    return (int16_t)(cwidth > _padX ? cwidth : _padX);
+}
+
+int16_t TFT_eSPI::drawCentreString(const char *string, int32_t x, int32_t y, uint8_t font)
+{
+    uint8_t datum = _textdatum;
+    _textdatum = TC_DATUM;
+    int16_t w = drawString(string, x, y, font);
+    _textdatum = datum;
+    return w;
+}
+
+int16_t TFT_eSPI::drawRightString(const char *string, int32_t x, int32_t y, uint8_t font)
+{
+    uint8_t datum = _textdatum;
+    _textdatum = TR_DATUM;
+    int16_t w = drawString(string, x, y, font);
+    _textdatum = datum;
+    return w;
+}
+
+uint16_t TFT_eSPI::color565(uint8_t r, uint8_t g, uint8_t b)
+{
+    return ((r & 0xF8) << 8) | ((g & 0xFC) << 3) | (b >> 3);
+}
+
+//====================================================
+// Profiler
+//====================================================
+
+void TFT_eSPI::beginFrame(void)
+{
+    size_t n = (size_t)_width * _height;
+    memcpy(_fb_prev, _fb, n * sizeof(uint16_t));
+    memset(_heat, 0, n * sizeof(uint16_t));
+    memset(&_stats, 0, sizeof(_stats));
+}
+
+const tft_frame_stats &TFT_eSPI::endFrame(void)
+{
+    size_t n = (size_t)_width * _height;
+    for (size_t i = 0; i < n; i++)
+    {
+        if (_heat[i])
+            _stats.unique_pixels++;
+        if (_heat[i] > _stats.max_writes)
+            _stats.max_writes = _heat[i];
+        if (_fb[i] != _fb_prev[i])
+            _stats.changed_pixels++;
+    }
+    return _stats;
+}
+
+uint16_t TFT_eSPI::readPixel(int32_t x, int32_t y) const
+{
+    if (x < 0 || y < 0 || x >= _width || y >= _height)
+        return 0;
+    return _fb[y * _width + x];
+}
+
+static void rgb565_to_rgb888(uint16_t c, uint8_t *rgb)
+{
+    rgb[0] = (uint8_t)(((c >> 11) & 0x1F) * 255 / 31);
+    rgb[1] = (uint8_t)(((c >> 5) & 0x3F) * 255 / 63);
+    rgb[2] = (uint8_t)((c & 0x1F) * 255 / 31);
+}
+
+bool TFT_eSPI::writeSnapshotPPM(const char *path) const
+{
+    FILE *f = fopen(path, "wb");
+    if (f == NULL)
+        return false;
+
+    fprintf(f, "P6\n%d %d\n255\n", _width, _height);
+    for (int32_t i = 0; i < (int32_t)_width * _height; i++)
+    {
+        uint8_t rgb[3];
+        rgb565_to_rgb888(_fb[i], rgb);
+        fwrite(rgb, 1, 3, f);
+    }
+    return fclose(f) == 0;
+}
+
+//====================================================
+// writeHeatmapPPM: Untouched pixels show the screen
+// dimmed, written pixels are coloured by write count:
+// 1 blue, 2 green, 3 yellow, 4-5 orange, 6-9 red and
+// 10 or more white.
+//====================================================
+bool TFT_eSPI::writeHeatmapPPM(const char *path) const
+{
+    static const uint8_t ramp[][3] = {
+        {0, 0, 200}, {0, 180, 0}, {230, 230, 0}, {255, 128, 0}, {255, 128, 0}, {230, 0, 0}, {230, 0, 0}, {230, 0, 0}, {230, 0, 0}};
+
+    FILE *f = fopen(path, "wb");
+    if (f == NULL)
+        return false;
+
+    fprintf(f, "P6\n%d %d\n255\n", _width, _height);
+    for (int32_t i = 0; i < (int32_t)_width * _height; i++)
+    {
+        uint8_t rgb[3];
+        if (_heat[i] == 0)
+        {
+            rgb565_to_rgb888(_fb[i], rgb);
+            uint8_t grey = (uint8_t)((rgb[0] + rgb[1] + rgb[2]) / 12);
+            rgb[0] = rgb[1] = rgb[2] = grey;
+        }
+        else if (_heat[i] >= 10)
+        {
+            rgb[0] = rgb[1] = rgb[2] = 255;
+        }
+        else
+        {
+            memcpy(rgb, ramp[_heat[i] - 1], 3);
+        }
+        fwrite(rgb, 1, 3, f);
+    }
+    return fclose(f) == 0;
+}
+
+const char *TFT_eSPI::primitiveName(int prim)
+{
+    static const char *names[TFT_PRIM_COUNT] = {
+        "pixel", "hline", "vline", "line", "rect", "fillrect", "triangle", "text", "padding"};
+    return (prim >= 0 && prim < TFT_PRIM_COUNT) ? names[prim] : "?";
+}
@@ -0,0 +1,202 @@
+#ifndef HOST_EMULATOR_TFT_ESPI_H
+#define HOST_EMULATOR_TFT_ESPI_H
+
+//====================================================
+// TFT_eSPI (host): RGB565 framebuffer implementation of
+// the TFT_eSPI subset the barometer draws with, plus an
+// SPI traffic profiler.
+//
+// Every primitive is broken down the same way TFT_eSPI
+// drives an ILI9341: an address window (CASET, PASET and
+// RAMWR, 11 bytes on the bus) followed by 2 bytes per
+// pixel. Lines are split into horizontal/vertical runs,
+// triangles into scanlines and text with a background
+// colour into one window per character cell. Glyphs are
+// a scaled 3x5 pixel font, so text cost is approximate.
+//
+// A frame is whatever is drawn between beginFrame() and
+// endFrame(). Per frame the profiler counts pushed
+// pixels, pixels that really changed colour, address
+// windows, bus bytes, and keeps a per pixel write count
+// for the overdraw heatmap.
+//====================================================
+
+#include "Arduino.h"
+
+#ifndef TFT_WIDTH
+#define TFT_WIDTH 240
+#endif
+#ifndef TFT_HEIGHT
+#define TFT_HEIGHT 320
+#endif
+#ifndef SPI_FREQUENCY
+#define SPI_FREQUENCY 40000000
+#endif
+
+#define TFT_EMU_WINDOW_BYTES 11 // CASET + 4, PASET + 4, RAMWR
+#define TFT_EMU_PIXEL_BYTES 2   // RGB565
+
+// Colours, same values as TFT_eSPI
+#define TFT_BLACK 0x0000
+#define TFT_NAVY 0x000F
+#define TFT_DARKGREEN 0x03E0
+#define TFT_DARKCYAN 0x03EF
+#define TFT_MAROON 0x7800
+#define TFT_PURPLE 0x780F
+#define TFT_OLIVE 0x7BE0
+#define TFT_LIGHTGREY 0xD69A
+#define TFT_DARKGREY 0x7BEF
+#define TFT_BLUE 0x001F
+#define TFT_GREEN 0x07E0
+#define TFT_CYAN 0x07FF
+#define TFT_RED 0xF800
+#define TFT_MAGENTA 0xF81F
+#define TFT_YELLOW 0xFFE0
+#define TFT_WHITE 0xFFFF
+#define TFT_ORANGE 0xFDA0
+#define TFT_GREENYELLOW 0xB5E0
+#define TFT_PINK 0xFE19
+
+// Text datums
+#define TL_DATUM 0
+#define TC_DATUM 1
+#define TR_DATUM 2
+#define ML_DATUM 3
+#define MC_DATUM 4
+#define MR_DATUM 5
+#define BL_DATUM 6
+#define BC_DATUM 7
+#define BR_DATUM 8
+
+#define GFXFF 1
+
+//====================================================
+// GFXfont: Only the metrics the emulator needs, the
+// firmware just passes the address to setFreeFont().
+//====================================================
+typedef struct
+{
+    const char *name;
+    uint8_t xAdvance;
+    uint8_t yAdvance;
+    uint8_t scale; // 3x5 glyph scale factor
+} GFXfont;
+
+extern const GFXfont FreeSans12pt7b;
+extern const GFXfont Orbitron_Light_24;
+
+enum tft_primitive
+{
+    TFT_PRIM_PIXEL,
+    TFT_PRIM_HLINE,
+    TFT_PRIM_VLINE,
+    TFT_PRIM_LINE,
+    TFT_PRIM_RECT,
+    TFT_PRIM_FILLRECT,
+    TFT_PRIM_TRIANGLE,
+    TFT_PRIM_TEXT,
+    TFT_PRIM_PADDING,
+    TFT_PRIM_COUNT
+};
+
+struct tft_prim_stats
+{
+    uint32_t calls;
+    uint32_t windows;
+    uint32_t pixels;
+    uint32_t bytes;
+};
+
+struct tft_frame_stats
+{
+    uint32_t pixels;         // Pixels pushed over the bus
+    uint32_t unique_pixels;  // Distinct pixels written at least once
+    uint32_t changed_pixels; // Pixels with a different colour at endFrame()
+    uint32_t max_writes;     // Highest write count of a single pixel
+    uint32_t windows;        // Address windows set
+    uint32_t bytes;          // Bytes on the SPI bus
+    tft_prim_stats prim[TFT_PRIM_COUNT];
+
+    float bus_ms(void) const { return bytes * 8.0f * 1000.0f / SPI_FREQUENCY; }
+    uint32_t overdraw(void) const { return pixels - unique_pixels; }
+};
+
+class TFT_eSPI
+{
+public:
+    TFT_eSPI(int16_t w = TFT_WIDTH, int16_t h = TFT_HEIGHT);
+    ~TFT_eSPI();
+
+    void init(void);
+    void setRotation(uint8_t r);
+    int16_t width(void) const { return _width; }
+    int16_t height(void) const { return _height; }
+
+    void fillScreen(uint32_t color);
+    void drawPixel(int32_t x, int32_t y, uint32_t color);
+    void drawFastHLine(int32_t x, int32_t y, int32_t w, uint32_t color);
+    void drawFastVLine(int32_t x, int32_t y, int32_t h, uint32_t color);
+    void drawLine(int32_t x0, int32_t y0, int32_t x1, int32_t y1, uint32_t color);
+    void drawRect(int32_t x, int32_t y, int32_t w, int32_t h, uint32_t color);
+    void fillRect(int32_t x, int32_t y, int32_t w, int32_t h, uint32_t color);
+    void fillTriangle(int32_t x0, int32_t y0, int32_t x1, int32_t y1, int32_t x2, int32_t y2, uint32_t color);
+
+    void setTextColor(uint16_t color);
+    void setTextColor(uint16_t fgcolor, uint16_t bgcolor, bool bgfill = false);
+    void setTextDatum(uint8_t datum) { _textdatum = datum; }
+    void setTextPadding(uint16_t x_width) { _padX = x_width; }
+    void setTextFont(uint8_t font) { _textfont = font; _gfxFont = NULL; }
+    void setFreeFont(const GFXfont *f);
+    int16_t textWidth(const char *string, uint8_t font);
+    int16_t fontHeight(uint8_t font);
+
+    int16_t drawString(const char *string, int32_t x, int32_t y, uint8_t font);
+    int16_t drawString(const char *string, int32_t x, int32_t y) { return drawString(string, x, y, _textfont); }
+    int16_t drawCentreString(const char *string, int32_t x, int32_t y, uint8_t font);
+    int16_t drawRightString(const char *string, int32_t x, int32_t y, uint8_t font);
+
+    uint16_t color565(uint8_t r, uint8_t g, uint8_t b);
+
+    // Emulator only
+    void beginFrame(void);
+    const tft_frame_stats &endFrame(void);
+    const tft_frame_stats &frameStats(void) const { return _stats; }
+    uint16_t readPixel(int32_t x, int32_t y) const;
+    bool writeSnapshotPPM(const char *path) const;
+    bool writeHeatmapPPM(const char *path) const;
+    static const char *primitiveName(int prim);
+
+private:
+    struct font_metrics
+    {
+        uint8_t advance;
+        uint8_t height;
+        uint8_t scale;
+    };
+
+    friend struct tft_prim_scope;
+
+    font_metrics metrics(uint8_t font) const;
+    void drawGlyph(char c, int32_t x, int32_t y, const font_metrics &m);
+
+    void window(int32_t x0, int32_t y0, int32_t x1, int32_t y1);
+    void push(int32_t x, int32_t y, uint16_t color);
+    void block(int32_t x, int32_t y, int32_t w, int32_t h, uint16_t color);
+
+    int16_t _width, _height;
+    uint16_t *_fb;
+    uint16_t *_fb_prev;
+    uint16_t *_heat;
+
+    uint16_t _textcolor = TFT_WHITE, _textbgcolor = TFT_WHITE;
+    uint8_t _textdatum = TL_DATUM;
+    uint8_t _textfont = 1;
+    uint16_t _padX = 0;
+    const GFXfont *_gfxFont = NULL;
+
+    tft_frame_stats _stats;
+    int _prim = TFT_PRIM_PIXEL;
+    int _depth = 0;
+};
+
+#endif
@@ -0,0 +1,169 @@
+#include "Wire.h"
+
+TwoWire Wire;
+
+// One bus, the fault and the lines are shared by every device on it
+static host_i2c_fault active_fault = I2C_FAULT_NONE;
+static uint8_t fault_addr = 0;
+static uint32_t fault_start_ms = 0;
+static uint32_t fault_duration_ms = 0;
+static uint8_t fault_release_pulses = 0;
+static uint8_t fault_pulses = 0;
+
+static float random_rate = 0.0f;
+static host_i2c_fault random_fault = I2C_FAULT_NONE;
+static uint32_t random_duration_ms = 0;
+static uint8_t random_release_pulses = 0;
+static uint32_t rng = 0x2545F491u;
+
+static bool device_absent[128];
+
+static host_i2c_stats bus_stats;
+static int bus_sda = SDA, bus_scl = SCL;
+static uint8_t scl_level = HIGH;
+
+static void expire(void)
+{
+    if (active_fault != I2C_FAULT_NONE && fault_duration_ms > 0 && millis() - fault_start_ms >= fault_duration_ms)
+        active_fault = I2C_FAULT_NONE;
+}
+
+static int read_line(uint8_t pin, int level)
+{
+    expire();
+    if (pin == bus_sda && active_fault == I2C_FAULT_SDA_LOW)
+        return LOW;
+    if (pin == bus_scl && active_fault == I2C_FAULT_SCL_LOW)
+        return LOW;
+    return level;
+}
+
+//====================================================
+// write_line: Counts rising SCL edges, each one clocks
+// one bit out of a device stuck mid-byte.
+//====================================================
+static void write_line(uint8_t pin, uint8_t level)
+{
+    if (pin != bus_scl)
+        return;
+
+    if (level == HIGH && scl_level == LOW)
+    {
+        bus_stats.scl_pulses++;
+        expire();
+        if (active_fault == I2C_FAULT_SDA_LOW && fault_release_pulses > 0 && ++fault_pulses >= fault_release_pulses)
+            active_fault = I2C_FAULT_NONE;
+    }
+    scl_level = level;
+}
+
+TwoWire::TwoWire()
+{
+    host_pin_hooks(read_line, write_line);
+}
+
+bool TwoWire::begin(int sda, int scl, uint32_t frequency)
+{
+    if (_running)
+        return true; // As the ESP32 core, a running bus keeps its settings
+
+    if (sda >= 0)
+        _sda = sda;
+    if (scl >= 0)
+        _scl = scl;
+    if (frequency > 0)
+        _frequency = frequency;
+    bus_sda = _sda;
+    bus_scl = _scl;
+    _running = true;
+    bus_stats.begins++;
+    return true;
+}
+
+bool TwoWire::end(void)
+{
+    _running = false;
+    return true;
+}
+
+bool TwoWire::setClock(uint32_t frequency)
+{
+    _frequency = frequency;
+    return true;
+}
+
+//====================================================
+// hostTransfer: One register access. A bus held low
+// costs the full timeout, a missing device fails at
+// the address byte.
+//====================================================
+bool TwoWire::hostTransfer(uint8_t addr)
+{
+    bus_stats.transfers++;
+    expire();
+
+    if (active_fault == I2C_FAULT_NONE && random_rate > 0.0f &&
+        (rng = rng * 1664525u + 1013904223u) < random_rate * 4294967295.0f)
+        injectFault(random_fault, random_duration_ms, 0, random_release_pulses);
+
+    if (!_running)
+    {
+        bus_stats.failed++;
+        return false;
+    }
+    if (active_fault == I2C_FAULT_SDA_LOW || active_fault == I2C_FAULT_SCL_LOW)
+    {
+        delay(_timeout_ms);
+        bus_stats.timeouts++;
+        bus_stats.failed++;
+        return false;
+    }
+    if ((active_fault == I2C_FAULT_NACK && (fault_addr == 0 || fault_addr == addr)) || device_absent[addr & 0x7F])
+    {
+        bus_stats.failed++;
+        return false;
+    }
+    return true;
+}
+
+uint8_t TwoWire::endTransmission(bool sendStop)
+{
+    (void)sendStop;
+    return hostTransfer(_tx_addr) ? 0 : 2;
+}
+
+void TwoWire::setPresent(uint8_t addr, bool present)
+{
+    device_absent[addr & 0x7F] = !present;
+}
+
+void TwoWire::injectFault(host_i2c_fault fault, uint32_t duration_ms, uint8_t addr, uint8_t release_pulses)
+{
+    active_fault = fault;
+    fault_addr = addr;
+    fault_start_ms = millis();
+    fault_duration_ms = duration_ms;
+    fault_release_pulses = release_pulses;
+    fault_pulses = 0;
+    if (fault != I2C_FAULT_NONE)
+        bus_stats.faults++;
+}
+
+void TwoWire::setFaultRate(float per_transfer, host_i2c_fault fault, uint32_t duration_ms, uint8_t release_pulses)
+{
+    random_rate = per_transfer;
+    random_fault = fault;
+    random_duration_ms = duration_ms;
+    random_release_pulses = release_pulses;
+}
+
+host_i2c_fault TwoWire::fault(void)
+{
+    expire();
+    return active_fault;
+}
+
+const host_i2c_stats &TwoWire::stats(void)
+{
+    return bus_stats;
+}
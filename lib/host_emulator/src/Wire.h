@@ -0,0 +1,82 @@
+#ifndef HOST_EMULATOR_WIRE_H
+#define HOST_EMULATOR_WIRE_H
+
+//====================================================
+// Wire (host): The I2C bus the fake sensors sit on,
+// with fault injection. Healthy transfers take no
+// virtual time, as before. Injected faults behave as on
+// a real bus:
+//
+//   NACK     a device (or all) does not answer, the
+//            transfer fails at once (unplugged, brown-out)
+//   SCL_LOW  a device holds SCL low, transfers run into
+//            the timeout, clock pulses cannot help
+//   SDA_LOW  a device was cut off mid-byte and holds SDA
+//            low, transfers run into the timeout until
+//            the master clocks it free with SCL pulses
+//
+// SDA and SCL read low through digitalRead() while a
+// device holds them. Faults end after their duration
+// (0 = never), SDA_LOW also after release_pulses clock
+// pulses on SCL (0 = only a power cycle helps).
+//
+// Every address answers unless setPresent() took the
+// device off the bus.
+//====================================================
+
+#include "Arduino.h"
+
+enum host_i2c_fault
+{
+    I2C_FAULT_NONE = 0,
+    I2C_FAULT_NACK,
+    I2C_FAULT_SCL_LOW,
+    I2C_FAULT_SDA_LOW
+};
+
+struct host_i2c_stats
+{
+    uint32_t transfers;
+    uint32_t failed;
+    uint32_t timeouts;
+    uint32_t scl_pulses; // Clocked by hand while the bus was stopped
+    uint32_t begins;
+    uint32_t faults; // Injected, scheduled or random
+};
+
+class TwoWire
+{
+public:
+    TwoWire();
+
+    bool begin(int sda = -1, int scl = -1, uint32_t frequency = 0);
+    bool end(void);
+    bool setClock(uint32_t frequency);
+    void setTimeOut(uint16_t timeout_ms) { _timeout_ms = timeout_ms; }
+    uint16_t getTimeOut(void) { return _timeout_ms; }
+
+    // Address-only write, as used to probe for a device. 0 if it answered, 2 (address NACK) on any failure.
+    void beginTransmission(uint8_t addr) { _tx_addr = addr; }
+    uint8_t endTransmission(bool sendStop = true);
+
+    // Host only, one register access of a fake device
+    bool hostTransfer(uint8_t addr);
+    static void setPresent(uint8_t addr, bool present);
+
+    // Host only, fault injection, addr 0 is every device
+    static void injectFault(host_i2c_fault fault, uint32_t duration_ms, uint8_t addr = 0, uint8_t release_pulses = 9);
+    static void setFaultRate(float per_transfer, host_i2c_fault fault, uint32_t duration_ms, uint8_t release_pulses = 9);
+    static host_i2c_fault fault(void);
+    static const host_i2c_stats &stats(void);
+
+private:
+    int _sda = SDA, _scl = SCL;
+    uint32_t _frequency = 100000;
+    uint16_t _timeout_ms = 50; // ESP32 core default
+    bool _running = false;
+    uint8_t _tx_addr = 0;
+};
+
+extern TwoWire Wire;
+
+#endif
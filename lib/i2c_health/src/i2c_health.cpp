@@ -0,0 +1,147 @@
+#include <Wire.h>
+#include "i2c_health.h"
+
+I2cHealth::I2cHealth(int sda, int scl, uint32_t clock_hz, uint16_t timeout_ms, uint32_t backoff_min_ms,
+                     uint32_t backoff_max_ms)
+    : _sda(sda), _scl(scl), _clock_hz(clock_hz), _timeout_ms(timeout_ms), _backoff_min_ms(backoff_min_ms),
+      _backoff_max_ms(backoff_max_ms), _healthy(true), _have_reading(false), _last_good_ms(0), _fault_ms(0),
+      _retry_ms(0), _backoff_ms(backoff_min_ms), _last_pulses(0)
+{
+    memset(&_stats, 0, sizeof(_stats));
+}
+
+//====================================================
+// begin: Starts the bus with the per-transfer timeout,
+// so no single transfer can block for longer.
+//====================================================
+void I2cHealth::begin(void)
+{
+    Wire.begin(_sda, _scl, _clock_hz);
+    Wire.setTimeOut(_timeout_ms);
+}
+
+bool I2cHealth::bus_idle(void)
+{
+    return digitalRead(_sda) == HIGH && digitalRead(_scl) == HIGH;
+}
+
+//====================================================
+// clear_bus: Bus clear as in the I2C specification
+// (UM10204, 3.1.16). With the controller stopped, SCL
+// is pulsed by hand until the device holding SDA low
+// has clocked out its byte, then a STOP resets every
+// device's bus logic. A device holding SCL low cannot
+// be cleared from here, only waited out.
+//====================================================
+bool I2cHealth::clear_bus(void)
+{
+    _stats.bus_clears++;
+    _last_pulses = 0;
+
+    Wire.end();
+    pinMode(_sda, INPUT_PULLUP);
+    pinMode(_scl, OUTPUT_OPEN_DRAIN);
+    digitalWrite(_scl, HIGH);
+    delayMicroseconds(I2C_HALF_CLOCK_US);
+
+    if (digitalRead(_scl) == HIGH)
+    {
+        while (digitalRead(_sda) == LOW && _last_pulses < I2C_CLEAR_PULSES)
+        {
+            digitalWrite(_scl, LOW);
+            delayMicroseconds(I2C_HALF_CLOCK_US);
+            digitalWrite(_scl, HIGH);
+            delayMicroseconds(I2C_HALF_CLOCK_US);
+            _last_pulses++;
+        }
+
+        // STOP: SDA rises while SCL is high
+        pinMode(_sda, OUTPUT_OPEN_DRAIN);
+        digitalWrite(_scl, LOW);
+        delayMicroseconds(I2C_HALF_CLOCK_US);
+        digitalWrite(_sda, LOW);
+        delayMicroseconds(I2C_HALF_CLOCK_US);
+        digitalWrite(_scl, HIGH);
+        delayMicroseconds(I2C_HALF_CLOCK_US);
+        digitalWrite(_sda, HIGH);
+        delayMicroseconds(I2C_HALF_CLOCK_US);
+    }
+
+    pinMode(_sda, INPUT);
+    pinMode(_scl, INPUT);
+    bool idle = bus_idle();
+    if (!idle)
+        _stats.stuck_clear++;
+
+    begin();
+    return idle;
+}
+
+void I2cHealth::note_time(uint32_t spent_ms)
+{
+    if (spent_ms > _stats.max_read_ms)
+        _stats.max_read_ms = spent_ms;
+}
+
+void I2cHealth::success(uint32_t now_ms, uint32_t spent_ms)
+{
+    note_time(spent_ms);
+    _stats.readings++;
+
+    if (!_healthy)
+    {
+        uint32_t latency = now_ms - _fault_ms;
+        _stats.recoveries++;
+        _stats.last_recovery_ms = latency;
+        _stats.total_recovery_ms += latency;
+        if (latency > _stats.max_recovery_ms)
+            _stats.max_recovery_ms = latency;
+    }
+
+    _healthy = true;
+    _have_reading = true;
+    _last_good_ms = now_ms;
+    _backoff_ms = _backoff_min_ms;
+}
+
+//====================================================
+// failure: The first failure of an episode allows an
+// immediate recovery attempt, every failed attempt
+// doubles the wait for the next one.
+//====================================================
+void I2cHealth::failure(uint32_t now_ms, uint32_t spent_ms)
+{
+    note_time(spent_ms);
+    _stats.failures++;
+
+    if (_healthy)
+    {
+        _healthy = false;
+        _stats.faults++;
+        _fault_ms = now_ms - spent_ms;
+        _retry_ms = now_ms;
+        return;
+    }
+
+    _retry_ms = now_ms + _backoff_ms;
+    _backoff_ms = _backoff_ms >= _backoff_max_ms / 2 ? _backoff_max_ms : 2 * _backoff_ms;
+}
+
+bool I2cHealth::retry_due(uint32_t now_ms) const
+{
+    return !_healthy && (int32_t)(now_ms - _retry_ms) >= 0;
+}
+
+uint32_t I2cHealth::retry_in(uint32_t now_ms) const
+{
+    if (_healthy || retry_due(now_ms))
+        return 0;
+    return _retry_ms - now_ms;
+}
+
+uint32_t I2cHealth::stale_ms(uint32_t now_ms) const
+{
+    if (_healthy)
+        return 0;
+    return now_ms - (_have_reading ? _last_good_ms : _fault_ms);
+}
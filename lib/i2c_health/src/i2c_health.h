@@ -0,0 +1,81 @@
+#ifndef I2C_HEALTH_H
+#define I2C_HEALTH_H
+
+//====================================================
+// i2c_health: Keeps the sensor bus usable when the
+// sensors are not.
+//
+// Every transfer is bounded by the Wire timeout, and
+// a bus with SDA or SCL held low is caught before the
+// next reading starts. After a failed reading the bus
+// is cleared (up to nine SCL pulses, then a STOP) and
+// the caller re-initializes its sensors. The first
+// attempt is immediate. Later ones back off
+// exponentially from backoff_min_ms to backoff_max_ms
+// and go back to the minimum after a good reading.
+// Between attempts the caller keeps drawing, with the
+// last reading marked stale.
+//
+// Recovery latency runs from the first failed reading
+// to the next good one.
+//====================================================
+
+#include <Arduino.h>
+
+#define I2C_CLEAR_PULSES 9 // Clocks out any byte a device got stuck in, plus the ACK
+#define I2C_HALF_CLOCK_US 5 // 100 kHz while clearing by hand
+
+struct i2c_health_stats
+{
+    uint32_t readings;    // Good readings
+    uint32_t failures;    // Failed readings, including failed recovery attempts
+    uint32_t faults;      // Fault episodes, good to failed
+    uint32_t recoveries;  // Fault episodes ended by a good reading
+    uint32_t bus_clears;  // Bus clear sequences run
+    uint32_t stuck_clear; // Clears that left a line low
+    uint32_t last_recovery_ms;
+    uint32_t max_recovery_ms;
+    uint64_t total_recovery_ms;
+    uint32_t max_read_ms; // Longest reading or recovery attempt, good or failed
+};
+
+class I2cHealth
+{
+public:
+    I2cHealth(int sda = SDA, int scl = SCL, uint32_t clock_hz = 100000, uint16_t timeout_ms = 10,
+              uint32_t backoff_min_ms = 250, uint32_t backoff_max_ms = 32000);
+
+    void begin(void);
+    bool bus_idle(void);  // SDA and SCL released, a transfer can start
+    bool clear_bus(void); // Returns true if both lines are released afterwards
+
+    void success(uint32_t now_ms, uint32_t spent_ms);
+    void failure(uint32_t now_ms, uint32_t spent_ms);
+
+    bool healthy(void) const { return _healthy; }
+    bool retry_due(uint32_t now_ms) const;
+    uint32_t retry_in(uint32_t now_ms) const; // 0 if healthy or due
+    uint32_t stale_ms(uint32_t now_ms) const; // Age of the last good reading, 0 if healthy
+    uint32_t backoff(void) const { return _backoff_ms; }
+    uint8_t last_pulses(void) const { return _last_pulses; }
+    const i2c_health_stats &stats(void) const { return _stats; }
+
+private:
+    void note_time(uint32_t spent_ms);
+
+    int _sda, _scl;
+    uint32_t _clock_hz;
+    uint16_t _timeout_ms;
+    uint32_t _backoff_min_ms, _backoff_max_ms;
+
+    bool _healthy;
+    bool _have_reading;
+    uint32_t _last_good_ms;
+    uint32_t _fault_ms;   // First failed reading of the episode
+    uint32_t _retry_ms;   // Next recovery attempt
+    uint32_t _backoff_ms; // Wait after the next failed attempt
+    uint8_t _last_pulses;
+    i2c_health_stats _stats;
+};
+
+#endif
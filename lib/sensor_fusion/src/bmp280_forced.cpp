@@ -0,0 +1,95 @@
+#include <Wire.h>
+#include "bmp280_forced.h"
+
+#define BMP280_STATUS_MEASURING 0x08
+#define BMP280_STATUS_RESERVED 0xF6 // Read as 0, set in the 0xF3 a failed read leaves behind
+#define BMP280_STARTUP_MS 2         // Soft reset to the first register write
+
+Bmp280Forced::Bmp280Forced(uint8_t addr, Adafruit_BMP280::sensor_sampling temp_os,
+                           Adafruit_BMP280::sensor_sampling press_os)
+    : _addr(addr), _temp_os(temp_os), _press_os(press_os), _started(false), _failed(false)
+{
+}
+
+//====================================================
+// begin: Sets the sensor up, at start-up and again
+// after an I2C fault. Adafruit_BMP280::begin() news its
+// I2C device and reads the calibration, so it runs only
+// until it first succeeds, after a probe so a missing
+// sensor does not allocate on every attempt. From then
+// on the sensor is soft reset and configured on the
+// existing device, there is no heap use in loop().
+//====================================================
+bool Bmp280Forced::begin(void)
+{
+    if (!_started)
+    {
+        Wire.begin(); // As the driver's begin(), a running bus keeps its settings
+        Wire.beginTransmission(_addr);
+        if (Wire.endTransmission() != 0 || !_bmp.begin(_addr))
+            return false;
+        _started = true;
+    }
+    else
+    {
+        // The sensor may have lost power during the fault, or been left mid-conversion
+        _bmp.reset();
+        delay(BMP280_STARTUP_MS);
+        if (_bmp.getStatus() & BMP280_STATUS_RESERVED)
+            return false; // Not answering
+    }
+
+    _bmp.setSampling(Adafruit_BMP280::MODE_SLEEP, _temp_os, _press_os, Adafruit_BMP280::FILTER_OFF,
+                     Adafruit_BMP280::STANDBY_MS_1);
+    return true;
+}
+
+bool Bmp280Forced::trigger(void)
+{
+    _bmp.setSampling(Adafruit_BMP280::MODE_FORCED, _temp_os, _press_os, Adafruit_BMP280::FILTER_OFF,
+                     Adafruit_BMP280::STANDBY_MS_1);
+    return true;
+}
+
+//====================================================
+// ready: A failed status read counts as done, so the
+// fusion does not wait for the timeout, and read() then
+// reports the failure.
+//====================================================
+bool Bmp280Forced::ready(void)
+{
+    uint8_t status = _bmp.getStatus();
+
+    _failed = status & BMP280_STATUS_RESERVED;
+    return _failed || !(status & BMP280_STATUS_MEASURING);
+}
+
+//====================================================
+// read: The driver does not report failed transfers.
+// A failed read returns the register address it wrote,
+// still in its buffer, and the compensation turns that
+// into a plausible looking number. The status register
+// is read again afterwards. A fault that hit the data
+// reads fails that read too, and its reserved bits show
+// it.
+//====================================================
+bool Bmp280Forced::read(float &pressure_pa, float &temp_c)
+{
+    if (_failed)
+        return false;
+
+    temp_c = _bmp.readTemperature();
+    pressure_pa = _bmp.readPressure();
+    return !(_bmp.getStatus() & BMP280_STATUS_RESERVED);
+}
+
+//====================================================
+// conversion_us: Maximum t_measure from the datasheet,
+// 1.25 ms + 2.3 ms per oversample + 0.575 ms setup.
+//====================================================
+uint32_t Bmp280Forced::conversion_us(void) const
+{
+    uint32_t os_t = _temp_os ? 1u << (_temp_os - 1) : 0;
+    uint32_t os_p = _press_os ? 1u << (_press_os - 1) : 0;
+    return 1250 + 2300 * (os_t + os_p) + (os_p ? 575 : 0);
+}
@@ -0,0 +1,39 @@
+#ifndef BMP280_FORCED_H
+#define BMP280_FORCED_H
+
+//====================================================
+// bmp280_forced: BMP280 in forced mode behind the
+// ForcedSensor interface. A forced conversion is started
+// by rewriting the control register with setSampling(),
+// the status register tells when it is done. The IIR
+// filter is off, sensor fusion filters its output.
+//====================================================
+
+#include <Adafruit_BMP280.h>
+#include "sensor_fusion.h"
+
+class Bmp280Forced : public ForcedSensor
+{
+public:
+    Bmp280Forced(uint8_t addr,
+                 Adafruit_BMP280::sensor_sampling temp_os = Adafruit_BMP280::SAMPLING_X2,
+                 Adafruit_BMP280::sensor_sampling press_os = Adafruit_BMP280::SAMPLING_X16);
+
+    bool begin(void);
+    uint8_t address(void) const { return _addr; }
+
+    bool trigger(void) override;
+    bool ready(void) override;
+    bool read(float &pressure_pa, float &temp_c) override;
+    uint32_t conversion_us(void) const override;
+
+private:
+    Adafruit_BMP280 _bmp;
+    uint8_t _addr;
+    Adafruit_BMP280::sensor_sampling _temp_os;
+    Adafruit_BMP280::sensor_sampling _press_os;
+    bool _started; // Adafruit_BMP280::begin() succeeded once
+    bool _failed;  // Last status read failed
+};
+
+#endif
@@ -0,0 +1,168 @@
+#include "sensor_fusion.h"
+
+SensorFusion::SensorFusion(float reject_pa, float learn_rate, uint32_t smooth_ms, float snap_pa)
+    : _count(0), _reject_pa(reject_pa), _learn_rate(learn_rate), _smooth_ms(smooth_ms), _snap_pa(snap_pa),
+      _last_pa(0.0f), _smooth_pa(0.0f), _last_ms(0), _have_last(false)
+{
+}
+
+bool SensorFusion::add(ForcedSensor *sensor, float offset_pa)
+{
+    if (sensor == NULL || _count >= FUSION_MAX_SENSORS)
+        return false;
+
+    _sensor[_count] = sensor;
+    _offset[_count] = offset_pa;
+    _learned[_count] = 0.0f;
+    _rejects[_count] = 0;
+    _count++;
+    return true;
+}
+
+void SensorFusion::setOffset(uint8_t i, float offset_pa)
+{
+    if (i < _count)
+        _offset[i] = offset_pa;
+}
+
+//====================================================
+// sample: Triggers all sensors, waits for the slowest
+// conversion (or a timeout of twice the worst case),
+// reads them back to back, fuses the readings and
+// filters the result. Returns false if no sensor delivered a reading.
+//====================================================
+bool SensorFusion::sample(fusion_result &out)
+{
+    float pressure[FUSION_MAX_SENSORS];
+    float temp[FUSION_MAX_SENSORS];
+    bool ok[FUSION_MAX_SENSORS];
+    bool done[FUSION_MAX_SENSORS];
+    uint32_t timeout_us = 0;
+    uint8_t pending = 0;
+
+    memset(&out, 0, sizeof(out));
+    uint32_t start = micros();
+
+    for (uint8_t i = 0; i < _count; i++)
+    {
+        ok[i] = false;
+        done[i] = !_sensor[i]->trigger();
+        if (done[i])
+        {
+            out.failed++;
+            continue;
+        }
+        pending++;
+        if (_sensor[i]->conversion_us() > timeout_us)
+            timeout_us = _sensor[i]->conversion_us();
+    }
+    timeout_us *= 2;
+
+    // Conversions overlap, so the wait is set by the slowest sensor
+    while (pending > 0)
+    {
+        for (uint8_t i = 0; i < _count; i++)
+        {
+            if (done[i] || !_sensor[i]->ready())
+                continue;
+
+            done[i] = true;
+            pending--;
+            ok[i] = _sensor[i]->read(pressure[i], temp[i]);
+            if (ok[i])
+                pressure[i] -= _offset[i] + _learned[i];
+            else
+                out.failed++;
+        }
+        if (pending == 0)
+            break;
+        if (micros() - start > timeout_us)
+        {
+            out.failed += pending;
+            break;
+        }
+        delayMicroseconds(FUSION_POLL_US);
+    }
+
+    // Reference value: median of the corrected readings, or the last fused value when only two disagree
+    float sorted[FUSION_MAX_SENSORS];
+    uint8_t n = 0;
+    for (uint8_t i = 0; i < _count; i++)
+    {
+        if (!ok[i])
+            continue;
+        uint8_t j = n++;
+        for (; j > 0 && sorted[j - 1] > pressure[i]; j--)
+            sorted[j] = sorted[j - 1];
+        sorted[j] = pressure[i];
+    }
+    if (n == 0)
+        return false;
+
+    float reference = (n & 1) ? sorted[n / 2] : (sorted[n / 2 - 1] + sorted[n / 2]) / 2.0f;
+    if (n == 2 && _have_last && sorted[1] - sorted[0] > _reject_pa)
+        reference = _last_pa;
+
+    float sum_p = 0.0f, sum_t = 0.0f;
+    bool accepted[FUSION_MAX_SENSORS];
+    int8_t closest = -1;
+    for (uint8_t i = 0; i < _count; i++)
+    {
+        accepted[i] = ok[i] && (n == 1 || fabsf(pressure[i] - reference) <= _reject_pa);
+        if (ok[i] && (closest < 0 || fabsf(pressure[i] - reference) < fabsf(pressure[closest] - reference)))
+            closest = i;
+        if (ok[i] && !accepted[i])
+        {
+            out.rejected++;
+            _rejects[i]++;
+        }
+    }
+    if (out.rejected == n)
+    {
+        // Nothing agrees with the reference, e.g. a real fast change, trust the closest one
+        accepted[closest] = true;
+        out.rejected--;
+        _rejects[closest]--;
+    }
+
+    for (uint8_t i = 0; i < _count; i++)
+    {
+        if (!accepted[i])
+            continue;
+        sum_p += pressure[i];
+        sum_t += temp[i];
+        out.used++;
+    }
+
+    out.pressure_pa = sum_p / out.used;
+    out.temp_c = sum_t / out.used;
+    out.latency_us = micros() - start;
+
+    // Learn offsets vs. the group, kept zero mean so the group average stays the absolute reference
+    if (out.used >= 2 && _learn_rate > 0.0f)
+    {
+        float mean = 0.0f;
+        for (uint8_t i = 0; i < _count; i++)
+        {
+            if (accepted[i])
+                _learned[i] += _learn_rate * (pressure[i] - out.pressure_pa);
+            mean += _learned[i];
+        }
+        mean /= _count;
+        for (uint8_t i = 0; i < _count; i++)
+            _learned[i] -= mean;
+    }
+
+    // Output filter over the real time since the last reading, so slow sampling is not smoothed over hours
+    uint32_t now_ms = millis();
+    _last_pa = out.pressure_pa;
+    if (_have_last && _smooth_ms > 0 && fabsf(out.pressure_pa - _smooth_pa) <= _snap_pa)
+    {
+        float dt = (float)(now_ms - _last_ms);
+        out.pressure_pa = _smooth_pa + (out.pressure_pa - _smooth_pa) * dt / (dt + (float)_smooth_ms);
+    }
+    _smooth_pa = out.pressure_pa;
+    _last_ms = now_ms;
+    _have_last = true;
+    return true;
+}
@@ -0,0 +1,81 @@
+#ifndef SENSOR_FUSION_H
+#define SENSOR_FUSION_H
+
+//====================================================
+// sensor_fusion: Samples several pressure sensors on
+// one I2C bus and fuses them into one reading.
+//
+// All sensors are triggered in forced mode first, so
+// the conversions run concurrently, then read back to
+// back. Every sensor has an offset (static calibration
+// plus a slowly learned part) that lines it up with the
+// group. Readings further than reject_pa from the
+// reference (median of three or more, otherwise the last
+// fused value) are rejected as outliers. The fused value
+// goes through a low-pass filter over the time between
+// readings, like the IIR filter of one sensor in normal
+// mode, but a change beyond snap_pa passes at once.
+//====================================================
+
+#include <Arduino.h>
+
+#define FUSION_MAX_SENSORS 4
+#define FUSION_POLL_US 250 // Conversion done polling interval
+#define FUSION_SMOOTH_MS 20000 // Output filter time constant, as quiet as IIR16 at one reading a second
+#define FUSION_SNAP_PA 10.0f   // Output filter follows larger changes at once
+
+//====================================================
+// ForcedSensor: One sensor that converts on request.
+//====================================================
+class ForcedSensor
+{
+public:
+    virtual ~ForcedSensor() {}
+    virtual bool trigger(void) = 0;                          // Start one conversion
+    virtual bool ready(void) = 0;                            // Conversion done
+    virtual bool read(float &pressure_pa, float &temp_c) = 0; // Read the result, false if the bus failed
+    virtual uint32_t conversion_us(void) const = 0;          // Worst case conversion time
+};
+
+struct fusion_result
+{
+    float pressure_pa;   // Fused pressure [Pa]
+    float temp_c;        // Mean temperature [C]
+    uint8_t used;        // Sensors in the result
+    uint8_t rejected;    // Sensors rejected as outliers
+    uint8_t failed;      // Sensors that did not convert in time or failed to read
+    uint32_t latency_us; // First trigger to fused result
+};
+
+class SensorFusion
+{
+public:
+    SensorFusion(float reject_pa = 50.0f, float learn_rate = 1.0f / 64.0f, uint32_t smooth_ms = FUSION_SMOOTH_MS,
+                 float snap_pa = FUSION_SNAP_PA);
+
+    bool add(ForcedSensor *sensor, float offset_pa = 0.0f);
+    uint8_t count(void) const { return _count; }
+    bool sample(fusion_result &out);
+
+    float offset(uint8_t i) const { return i < _count ? _offset[i] + _learned[i] : 0.0f; }
+    void setOffset(uint8_t i, float offset_pa);
+    uint32_t rejects(uint8_t i) const { return i < _count ? _rejects[i] : 0; }
+
+private:
+    ForcedSensor *_sensor[FUSION_MAX_SENSORS];
+    float _offset[FUSION_MAX_SENSORS];  // Static calibration [Pa]
+    float _learned[FUSION_MAX_SENSORS]; // Learned offset vs. the group [Pa]
+    uint32_t _rejects[FUSION_MAX_SENSORS];
+    uint8_t _count;
+
+    float _reject_pa;
+    float _learn_rate;
+    uint32_t _smooth_ms;
+    float _snap_pa;
+    float _last_pa;    // Last fused value before the output filter
+    float _smooth_pa;  // Last filtered output
+    uint32_t _last_ms; // Time of the last fused value
+    bool _have_last;
+};
+
+#endif
@@ -23,3 +23,42 @@ void debug_sensor_bme280(int32_t temp, int32_t humidity, int32_t pressure, int16
     sprintf(buf, " [C], [%%RH], [mbar] [min  sec]");
     Serial.println(buf);
 }
+
+//====================================================
+// debug_sampler: Prints the adaptive sampling state and
+// how the readings spread over the interval buckets,
+// count and share of the time covered.
+//====================================================
+void debug_sampler(void)
+{
+    float total = 0;
+
+    for (uint8_t i = 0; i < SAMPLER_BUCKETS; i++)
+        total += sampler.bucket(i).seconds;
+
+    Serial.printf("SMP: %u readings, %u jumps, next %u ms, trend %.4f Pa/s, scatter %.2f Pa\n", sampler.samples(),
+                  sampler.jumps(), sampler.interval(), sampler.slope(), sampler.residual());
+    for (uint8_t i = 0; i < SAMPLER_BUCKETS; i++)
+    {
+        const sampler_bucket &b = sampler.bucket(i);
+        if (b.upto_ms == UINT32_MAX)
+            Serial.printf("SMP:  >%4u s", sampler.bucket(i - 1).upto_ms / 1000);
+        else
+            Serial.printf("SMP: <=%4u s", b.upto_ms / 1000);
+        Serial.printf(" %6u readings %5.1f%% of time\n", b.samples, total > 0 ? 100.0 * b.seconds / total : 0.0);
+    }
+}
+
+//====================================================
+// debug_i2c: Prints the sensor bus health, fault and
+// recovery counts and how long recoveries took.
+//====================================================
+void debug_i2c(void)
+{
+    const i2c_health_stats &s = i2c_health.stats();
+
+    Serial.printf("I2C: %u readings, %u failed, %u faults, %u recovered, %u bus clears (%u left a line low)\n",
+                  s.readings, s.failures, s.faults, s.recoveries, s.bus_clears, s.stuck_clear);
+    Serial.printf("I2C: recovery last %u ms, mean %u ms, max %u ms, longest reading %u ms\n", s.last_recovery_ms,
+                  s.recoveries ? (uint32_t)(s.total_recovery_ms / s.recoveries) : 0, s.max_recovery_ms, s.max_read_ms);
+}
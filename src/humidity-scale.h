@@ -119,11 +119,11 @@ void update_humidity_needle(int value, int tempvalue, byte ms_delay, int16_t p_m
   tft.setTextColor(TFT_BLACK, TFT_WHITE);
   float fahrenheit_tempvalue = ((float)tempvalue * 9.0 / 5.0) + 32.0;
 
-  static char buf[9];
+  char buf[16]; // Room for any int plus the label
   sprintf(buf, " %d%%RH", value);
   tft.drawRightString(buf, 62, 119 - 20, 2); // Relative humidity at bottom left
 
-  static char buf_l[14];
+  char buf_l[16];
   sprintf(buf_l, "%d MI", p_min);
   tft.drawRightString(buf_l, 125, 119 - 20, 2); // Relative humidity at bottom left
 
@@ -134,11 +134,10 @@ void update_humidity_needle(int value, int tempvalue, byte ms_delay, int16_t p_m
   tft.drawString("D E B U G", 90, 119 - 20, 2); // 'DEBUG' text in the middle bottom
 #endif
 
+  char tmpbuf[16]; // "100 F" or "-10 C" did not fit the old 5 bytes
 #if FAHRENHEIT == 1
-  char tmpbuf[5];
   sprintf(tmpbuf, "%d F", (int)round(fahrenheit_tempvalue));
 #else
-  char tmpbuf[5];
   sprintf(tmpbuf, "%d C", tempvalue);
 #endif
 
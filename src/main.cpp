@@ -63,6 +63,18 @@ GND         -> BME280 GND
 #include <TFT_eSPI.h> // Display hardware-specific library
 #include <SPI.h>
 #include <ESP32Time.h>
+#include <static_arena.h>
+#include <sample_history.h>
+#include <adaptive_sampler.h>
+#include <time_weighted_mean.h>
+#include <pressure_pipeline.h>
+#include <i2c_health.h>
+#include <history_http.h>
+#ifdef ARDUINO_ARCH_ESP32
+#include <wifi_transport.h>
+#else
+#include <posix_transport.h>
+#endif
 
 // #define BME280
 #define BMP280
@@ -72,7 +84,11 @@ GND         -> BME280 GND
 BME280_Class BME280;
 #else
 #include <Adafruit_BMP280.h>
-Adafruit_BMP280 BME280;
+#include <sensor_fusion.h>
+#include <bmp280_forced.h>
+Bmp280Forced sensor_alt(BMP280_ADDRESS_ALT); // 0x76
+Bmp280Forced sensor_std(BMP280_ADDRESS);     // 0x77, optional second sensor
+SensorFusion fusion;                         // Concurrent forced-mode sampling of both
 #endif
 
 //===========================================
@@ -84,13 +100,32 @@ Adafruit_BMP280 BME280;
 #define CF_OL24 &Orbitron_Light_24
 #define TFT_GREY 0x5AEB
 
-#define MINPRESSURE 997    // hPa/mbar
-#define MAXPRESSURE 1036   // hPa/mbar
-#define MAXHOURTIMESLOT 11 // Number of possible one hour time slots
+// Scale window and hour slots, MINPRESSURE ... HOURSLOT_MS, see pressure_pipeline.h
 
 #define FAHRENHEIT 1 // '0' for temperature in degree Celsius, '1' for degree Fahrenheit
 #define HEIGHT 162   // Height in Meters
 
+#define SAMPLEMIN_MS 1000     // Shortest interval between readings, fast changes
+#define SAMPLEMAX_MS 300000   // Longest interval between readings, calm weather
+#define SAMPLESTEP_PA 2.0     // Pressure change [Pa] that makes a new reading worthwhile
+#define SAMPLENOISE_PA 1.0    // Sensor noise [Pa], scatter beyond it counts as weather
+
+#define I2C_CLOCK_HZ 100000      // Sensor bus clock
+#define I2C_TIMEOUT_MS 10        // Longest a single I2C transfer may block
+#define I2C_BACKOFF_MIN_MS 250   // Sensor recovery attempts back off from this ...
+#define I2C_BACKOFF_MAX_MS 32000 // ... up to this, also the slowest stale display update
+
+#define HISTORYSAMPLES 720 // Samples kept for /history, 12 min at 1 s up to 60 h at 5 min
+#define ARENA_BYTES 9216   // Static arena for the runtime data, 12 bytes per history sample + hour slots, see MEM: lines
+#define HTTP_POLL_MS 10    // HTTP server poll interval while waiting for the next reading
+#ifndef HTTP_PORT
+#define HTTP_PORT 80 // '0' disables the HTTP server
+#endif
+#ifndef WIFI_SSID
+#define WIFI_SSID "" // Set WiFi credentials in build_flags, -DWIFI_SSID=\"...\" -DWIFI_PASSWORD=\"...\"
+#define WIFI_PASSWORD ""
+#endif
+
 //===========================================
 // Debug code, set MYDEBUG to 1
 //===========================================
@@ -113,13 +148,27 @@ void setup_humidity_meter(void);
 void update_humidity_needle(int value, int tempvalue, byte ms_delay, int16_t p_min, int16_t p_max);
 void setup_pressure_scales(const char *label, int x, int y);
 void update_pressure_arrows(void);
+void update_pressure_scale_labels(void);
 char *pressure_diff_to_1013(int value);
 
 int16_t *update_pressure_array(int16_t pressure_now);
-int16_t *map_pressure_values(int16_t *pressure_array);
-int16_t is_outside_range(int16_t *pressure_array);
+int16_t *map_pressure_values(int16_t *pressure_array, int16_t full_remap);
+int16_t select_pressure_window(int16_t *pressure_array);
 
 void debug_sensor_bme280(int32_t temp, int32_t humidity, int32_t pressure, int16_t rtc_minute, int16_t rtc_second);
+void debug_sampler(void);
+void debug_i2c(void);
+uint8_t setup_sensors(void);
+int16_t read_sensors(int32_t &temp, int32_t &humidity, int32_t &pressure);
+void setup_memory(void);
+void seal_memory(void);
+void debug_memory(void);
+
+#ifndef BME280
+uint8_t setup_fusion_sensors(void);
+int16_t read_fusion_sensors(int32_t &temp, int32_t &pressure);
+void debug_fusion(fusion_result &fused);
+#endif
 
 //===========================================
 // Global instantiation
@@ -128,7 +177,12 @@ void debug_sensor_bme280(int32_t temp, int32_t humidity, int32_t pressure, int16
 ESP32Time rtc;
 TFT_eSPI tft = TFT_eSPI();
 
-int16_t pressure_array[MAXHOURTIMESLOT] = {0};
+alignas(ARENA_ALIGN) uint8_t arena_storage[ARENA_BYTES];
+StaticArena arena(arena_storage, ARENA_BYTES); // All runtime data, allocated in setup()
+uint32_t heap_blocks_at_setup = 0;
+
+int16_t *pressure_data = NULL; // Hour slots [hPa], from the arena
+int16_t *meter_data = NULL;    // Hour slots mapped to the meter scale [0,100], from the arena
 // BME280_Class BME280;
 uint16_t osx = 120, osy = 120; // Saved x & y coords
 uint16_t last_hour = 0;
@@ -138,8 +192,24 @@ int value[6] = {0, 0, 0, 0, 0, 0};
 int old_value[6] = {-1, -1, -1, -1, -1, -1};
 int d = 0;
 int16_t do_update_flag = 1; // Initially true for 'now' reading
+uint32_t next_shift_ms = 0; // Next hour slot shift, on a fixed one hour grid from the first reading
 
 int32_t pressure_max = 5, pressure_min = 200000;
+int16_t range_min = MINPRESSURE, range_max = MAXPRESSURE; // Current scale window
+float shown_pressure = 0;                                 // Last good sea level pressure [hPa], kept on screen while stale
+
+I2cHealth i2c_health(SDA, SCL, I2C_CLOCK_HZ, I2C_TIMEOUT_MS, I2C_BACKOFF_MIN_MS, I2C_BACKOFF_MAX_MS); // Sensor bus timeouts, clearing and recovery
+
+AdaptiveSampler sampler(SAMPLEMIN_MS, SAMPLEMAX_MS, SAMPLESTEP_PA, SAMPLENOISE_PA); // Time to the next reading
+TimeWeightedMean hour_mean;                                                        // Pressure [hPa] over the current hour slot
+
+SampleHistory sample_history; // Latest samples for /history and /live, storage from the arena
+#ifdef ARDUINO_ARCH_ESP32
+WiFiTransport net_transport(WIFI_SSID, WIFI_PASSWORD);
+#else
+PosixTransport net_transport; // Host build, loopback
+#endif
+HistoryHttpServer http_server(net_transport, sample_history);
 
 //===========================================
 // In file prototypes
@@ -147,11 +217,19 @@ int32_t pressure_max = 5, pressure_min = 200000;
 
 int16_t one_minute_done(void);
 int16_t one_hour_done(void);
+uint32_t ms_to_shift(void);
+void serve_http(uint32_t ms);
+void draw_pressure_value(float fpres, uint32_t stale_ms);
 
 #include "humidity-scale.h"
 #include "pressure-data.h"
 #include "pressure-scale.h"
 #include "debug.h"
+#include "memory-report.h"
+#ifndef BME280
+#include "multi-sensor.h"
+#endif
+#include "sensor-health.h"
 
 // #########################################################################
 // ######                           SETUP                             ######
@@ -161,43 +239,28 @@ void setup(void)
 {
 
     // RTC as EPOCH date/time like 1st Jan 1970 00:00:00,
-    // only minute and hour transition 0 -> 1 is used
+    // only minute transition 0 -> 1 is used (MYDEBUG)
     rtc.setTime(0, 0, 0, 1, 1, 1970);
+    next_shift_ms = millis() + HOURSLOT_MS; // Restarted by the first reading
 
     Serial.begin(115200);
     while (!Serial)
         ;
 
-    // while (!BME280.begin(I2C_STANDARD_MODE)) {
-#ifdef BME280
-    while (!BME280.begin(I2C_FAST_MODE_PLUS_MODE))
+    setup_memory(); // Sized at compile time, see ARENA_BYTES
+
+    // A missing or hung sensor does not stop the start-up, read_sensors() keeps trying in the background
+    i2c_health.begin();
+    if (setup_sensors() == 0)
     {
-        Serial.print(F("-  Unable to find BME280 on I2C. Press reset, or check connections, and try again in 5 seconds.\n"));
-        delay(5000);
+        Serial.print(F("-  Unable to find the pressure sensor on I2C, check connections. Retrying in the background.\n"));
+        i2c_health.failure(millis(), 0);
     }
-    BME280.mode(NormalMode);
-    BME280.setOversampling(TemperatureSensor, Oversample16);
-    BME280.setOversampling(HumiditySensor, Oversample16);
-    BME280.setOversampling(PressureSensor, Oversample16);
-    BME280.iirFilter(IIR16);
-    // BME280.setIIRFilter(IIR4);
-    // BME280.setGas(0, 0);        // 0,0 means no heated gas measurements
-    BME280.inactiveTime(inactive1000ms);
-
-    debug(F("- Setting 16x oversampling for all sensors\n"));
-    debug(F("- Setting IIR filter to a value of 4 samples\n"));
-    debug(F("\nTemp [C] Humid [RH%] Press [hPa/mbar] [min  sec]"));
-    debug(F("\n================================================\n"));
-#else
-    while (!BME280.begin(BMP280_ADDRESS_ALT))
+
+    if (HTTP_PORT && http_server.begin(HTTP_PORT))
     {
-        BME280.setSampling(Adafruit_BMP280::MODE_NORMAL,     /* Operating Mode. */
-                           Adafruit_BMP280::SAMPLING_X2,     /* Temp. oversampling */
-                           Adafruit_BMP280::SAMPLING_X16,    /* Pressure oversampling */
-                           Adafruit_BMP280::FILTER_X16,      /* Filtering. */
-                           Adafruit_BMP280::STANDBY_MS_500); /* Standby time. */
+        Serial.printf("- HTTP server on port %d, /history and /live\n", HTTP_PORT);
     }
-#endif
 
     tft.init();
     tft.setRotation(0);
@@ -216,6 +279,9 @@ void setup(void)
     setup_pressure_scales("-1h", 4 * d, 160);
     setup_pressure_scales("Now", 5 * d, 160);
 
+    seal_memory(); // Nothing is allocated after this point
+    debug_memory();
+
     debug(F("Setup done"));
 }
 
@@ -227,61 +293,51 @@ void loop()
 {
 
     int32_t temp = 0, humidity = 0, pressure = 0, gas = 0;
-    char bufpres[20] = ""; // sprintf text buffer
     float fpres;
     uint8_t dpres;
     int16_t array_cnt = 0;
     double Pressure2, Pressure2plus;
     double myT, myP;
 
-    delay(5000); // Wait 5 s before acquiring the new BME280 environmental data
+    // Wait 1 s to 5 min before acquiring the new environmental data, see sampler, but read on the hour slot
+    // shift, not up to 5 min after it. While the sensor is faulty, wait for the next recovery attempt instead.
+    serve_http(i2c_health.healthy() ? min(sampler.interval(), ms_to_shift()) : i2c_health.retry_in(millis()));
 
     // Throw away first reading, I2C/BME280 garbage
     if (do_update_flag == 1)
     {
-#ifdef BME280
-        BME280.getSensorData(temp, humidity, pressure);
-#else
-        temp = BME280.readTemperature();
-        pressure = BME280.readPressure() - 200.0; // -2.0 mb Correction
-        humidity = 12.3;
-#endif
-        delay(1000);
+        read_sensors(temp, humidity, pressure);
+        serve_http(1000);
     }
-#ifdef BME280
-    BME280.getSensorData(temp, humidity, pressure); // Get real data, ignore gas value
-    if (pressure < 1000)
+    if (!read_sensors(temp, humidity, pressure))
     {
-        delay(1000);
-        BME280.getSensorData(temp, humidity, pressure); // Get real data, ignore gas value
-        if (pressure < 1000)
-        {
-            Serial.printf("Retry Succeeded");
-        }
-        else
-        {
-            Serial.printf("Retry Failed");
-        }
+        // Sensor lost, keep the last reading on screen and show its age until it recovers
+        draw_pressure_value(shown_pressure, i2c_health.stale_ms(millis()));
+        return;
     }
-#else
-    temp = BME280.readTemperature();
-    pressure = BME280.readPressure() - 200.0; // -2.0 mb Correction
-    humidity = 12.3 * 100.0;
+#ifndef BME280
+    pressure = pressure - 200.0; // -2.0 mb Correction
 #endif
     myP = double(pressure) / 100.0;
     myT = double(temp) / 100.0;
 
+    // Raw reading for host analysis of collected logs (tools/fleet_analytics): millis, station Pa, 1/100 C, humidity, height
+    Serial.printf("LOG: %lu %ld %ld %ld %d\n", (unsigned long)millis(), (long)pressure, (long)temp, (long)humidity, HEIGHT);
+
     // Adjust pressure back to SeaLevel Pressure based on current elevation, Height in meters
 
-    Pressure2 = myP;
-    Pressure2plus = -Pressure2 + Pressure2 / pow((1.0 - (0.0065 * double(HEIGHT) / (myT + 0.0065 * double(HEIGHT) + 273.15))), 5.25588);
-    Serial.printf("TAW: %.3f %.3f %.3f", Pressure2, Pressure2plus, Pressure2 + Pressure2plus);
-    Pressure2 = Pressure2 + Pressure2plus;
+    Pressure2 = baro_sea_level(myP, myT, HEIGHT);
+    Pressure2plus = Pressure2 - myP;
+    Serial.printf("TAW: %.3f %.3f %.3f", myP, Pressure2plus, Pressure2);
     pressure = int(Pressure2 * 100.0);
     Serial.printf(" %.3d ", pressure);
 
     fpres = Pressure2;
 
+    sample_history.push({millis(), pressure, (int16_t)temp, (uint16_t)humidity}); // Streamed by /history and /live
+    sampler.update(millis(), pressure);                                           // Sooner when the pressure moves
+    hour_mean.add(millis(), fpres);
+
     debug_sensor_bme280(temp, humidity, pressure, rtc.getMinute(), rtc.getSecond());
 
 //
@@ -293,15 +349,36 @@ void loop()
         rtc.setTime(0, 0, 0, 1, 1, 1970); // Ensure that we only does a barometric scale pointers one per minute update.
 #else
     if (one_hour_done() || do_update_flag)
-    {                                     // Shift barometric scale pointers once in an hour in REAL mode
-        rtc.setTime(0, 0, 0, 1, 1, 1970); // Ensure that we only does a barometric scale pointers one per hour update.
+    { // Shift barometric scale pointers once in an hour in REAL mode
 #endif
 
         int16_t *p_pressure;    // Raw BME280 sensor pressure values (hPa aka mbar)
         int16_t *p_metervalues; // Pressure values mapped in the range [0,100], to fit meter scale
+        int16_t window_moved;   // Scale window shifted, remap everything and relabel
+        int16_t missed_hours;   // Extra shifts for hours without a reading, remap everything
 
-        p_pressure = update_pressure_array(fpres);       // First 'Now'-pressure is added to the pressure array
-        p_metervalues = map_pressure_values(p_pressure); // Retrieve mapped values for meter usage
+        // The hour slot holds the time weighted mean of the past hour, readings come at uneven intervals
+        if (!do_update_flag)
+        {
+            debug_sampler();
+            debug_i2c();
+            debug_memory();
+        }
+        p_pressure = update_pressure_array(do_update_flag ? fpres : hour_mean.mean()); // First 'Now'-pressure is added to the pressure array
+        // The next shift is one hour after the last one was due, not after this reading, so late readings
+        // do not stretch the slots. Every hour missed while the sensor was lost gets its slot, with the same
+        // mean, so the slots stay at their -1h..-10h places.
+        next_shift_ms = do_update_flag ? millis() + HOURSLOT_MS : next_shift_ms + HOURSLOT_MS;
+        missed_hours = 0;
+        while ((int32_t)(millis() - next_shift_ms) >= 0)
+        {
+            p_pressure = update_pressure_array(hour_mean.mean());
+            next_shift_ms += HOURSLOT_MS;
+            missed_hours++;
+        }
+        hour_mean.restart();
+        window_moved = select_pressure_window(p_pressure) || do_update_flag;           // Auto-range the scales
+        p_metervalues = map_pressure_values(p_pressure, window_moved || missed_hours); // Retrieve mapped values for meter usage
 
         // You can select different time slots than default, up to (MAXHOURTIMESLOT-1)
         value[0] = p_metervalues[10]; // -10 hour ago pressure
@@ -314,6 +391,8 @@ void loop()
         //
         // Draw the six analog scales with the barometric history
         //
+        if (window_moved)
+            update_pressure_scale_labels();
         update_pressure_arrows();
     } // end-if
 
@@ -329,59 +408,110 @@ void loop()
 
     Serial.printf("TAW2: %4d, %4d\n", pressure_min, pressure_max);
 
-    //
-    // Print pressure value with two decimals
-    //
+    shown_pressure = fpres;
+    draw_pressure_value(fpres, 0);
+
+    do_update_flag = 0; // No need for flag after initial first BME280 reading
+}
+
+//====================================================
+// one_minute_done: Returns 'true'/1, on the new
+// minute shift, otherwise returns 'false'/0.
+//====================================================
+int16_t one_minute_done(void)
+{
+
+    if (rtc.getMinute() > 0)
+    {
+        return 1;
+    }
+    return 0;
+}
+//====================================================
+// serve_http: Waits like delay(), but keeps the HTTP
+// server answering /history and /live meanwhile.
+//====================================================
+void serve_http(uint32_t ms)
+{
+    uint32_t start = millis();
+
+    do
+    {
+        if (!http_server.poll())
+            delay(HTTP_POLL_MS);
+    } while (millis() - start < ms);
+}
+
+//====================================================
+// draw_pressure_value: Prints the pressure with two
+// decimals below the humidity meter. A stale value
+// (sensor lost for stale_ms) is drawn in orange with
+// its age in place of the unit.
+//====================================================
+void draw_pressure_value(float fpres, uint32_t stale_ms)
+{
+    char bufpres[20] = ""; // sprintf text buffer
+
     tft.setTextPadding(tft.width());
     tft.setTextDatum(TL_DATUM);
-    if (fpres > MAXPRESSURE)
+    if (fpres <= 0)
     {
-        sprintf(bufpres, "++ %8.2f mb", fpres); // Indicating now-value is outside MAXPRESSURE range
+        snprintf(bufpres, sizeof(bufpres), "  ------- mb"); // No reading yet
     }
-    else if (fpres < MINPRESSURE)
+    else if (stale_ms > 0)
     {
-        sprintf(bufpres, "-- %8.2f mb", fpres); // Indicating now-value is outside MINPRESSURE range
+        uint32_t age_s = stale_ms / 1000;
+        if (age_s < 60)
+            snprintf(bufpres, sizeof(bufpres), "  %7.2f %2lus", fpres, (unsigned long)age_s); // Seconds old
+        else if (age_s < 6000)
+            snprintf(bufpres, sizeof(bufpres), "  %7.2f %2lum", fpres, (unsigned long)(age_s / 60)); // Minutes old
+        else
+            snprintf(bufpres, sizeof(bufpres), "  %7.2f %2luh", fpres, (unsigned long)(age_s / 3600 % 100)); // Hours old
+    }
+    else if (fpres > range_max)
+    {
+        snprintf(bufpres, sizeof(bufpres), "++ %8.2f mb", fpres); // Indicating now-value is above the scale window
+    }
+    else if (fpres < range_min)
+    {
+        snprintf(bufpres, sizeof(bufpres), "-- %8.2f mb", fpres); // Indicating now-value is below the scale window
     }
     else
     {
-        sprintf(bufpres, "  %8.2f mb", fpres); // Pressure hPascals=mbar
+        snprintf(bufpres, sizeof(bufpres), "  %8.2f mb", fpres); // Pressure hPascals=mbar
     }
 
     Serial.println(bufpres);
 
-    tft.setTextColor(TFT_WHITE, TFT_BLACK);
+    tft.setTextColor(stale_ms > 0 ? TFT_ORANGE : TFT_WHITE, TFT_BLACK);
     tft.setFreeFont(CF_OL24);                // Select the font
     tft.drawString(bufpres, 15, 128, GFXFF); // Print the mb value
 
     // Reset text padding to zero (default)
     tft.setTextPadding(0);
-
-    do_update_flag = 0; // No need for flag after initial first BME280 reading
 }
 
 //====================================================
-// one_minute_done: Returns 'true'/1, on the new
-// minute shift, otherwise returns 'false'/0.
+// one_hour_done: Returns 'true'/1, on the new
+// hour shift, otherwise returns 'false'/0.
 //====================================================
-int16_t one_minute_done(void)
+int16_t one_hour_done(void)
 {
 
-    if (rtc.getMinute() > 0)
+    if ((int32_t)(millis() - next_shift_ms) >= 0)
     {
         return 1;
     }
     return 0;
 }
+
 //====================================================
-// one_hour_done: Returns 'true'/1, on the new
-// hour shift, otherwise returns 'false'/0.
+// ms_to_shift: Time left to the next hour slot shift,
+// 0 if it is due.
 //====================================================
-int16_t one_hour_done(void)
+uint32_t ms_to_shift(void)
 {
+    int32_t left = (int32_t)(next_shift_ms - millis());
 
-    if (rtc.getHour() > 0)
-    {
-        return 1;
-    }
-    return 0;
+    return left > 0 ? (uint32_t)left : 0;
 }
@@ -0,0 +1,71 @@
+
+#ifdef ARDUINO_ARCH_ESP32
+#include <esp_heap_caps.h>
+#endif
+
+// Everything setup_memory() takes, with the worst case alignment padding in front of each allocation
+static_assert(ARENA_BYTES >= HISTORYSAMPLES * sizeof(baro_sample) + 2 * MAXHOURTIMESLOT * sizeof(int16_t) +
+                                 (alignof(baro_sample) - 1) + 2 * (alignof(int16_t) - 1),
+              "ARENA_BYTES is too small for the runtime data, increase it or reduce HISTORYSAMPLES");
+
+//====================================================
+// setup_memory: Carves the runtime data out of the
+// static arena. The static_assert above makes sure it
+// fits, there is nothing to retry at run time.
+//====================================================
+void setup_memory(void)
+{
+  baro_sample *history = arena.alloc_array<baro_sample>(HISTORYSAMPLES);
+
+  pressure_data = arena.alloc_array<int16_t>(MAXHOURTIMESLOT);
+  meter_data = arena.alloc_array<int16_t>(MAXHOURTIMESLOT);
+
+  sample_history.begin(history, HISTORYSAMPLES);
+}
+
+//====================================================
+// seal_memory: End of setup(), the arena takes no more
+// allocations and the heap is noted as the baseline for
+// allocations made by loop().
+//====================================================
+void seal_memory(void)
+{
+  arena.seal();
+#ifdef ARDUINO_ARCH_ESP32
+  multi_heap_info_t heap;
+  heap_caps_get_info(&heap, MALLOC_CAP_8BIT);
+  heap_blocks_at_setup = heap.allocated_blocks;
+#endif
+}
+
+//====================================================
+// debug_memory: Prints arena usage, the heap low-water
+// mark and the stack high-water mark of every task to
+// the Arduino serial port.
+//====================================================
+void debug_memory(void)
+{
+  Serial.printf("MEM: arena %u of %u bytes, %u allocations, %u failed, %u after setup\n", (unsigned)arena.used(),
+                (unsigned)arena.size(), arena.allocations(), arena.failed(), arena.late());
+
+#ifdef ARDUINO_ARCH_ESP32
+  static const char *tasks[] = {"loopTask", "IDLE", "Tmr Svc", "esp_timer", "ipc0", "ipc1",
+                                "wifi", "tiT", "sys_evt", "arduino_events"};
+  multi_heap_info_t heap;
+
+  heap_caps_get_info(&heap, MALLOC_CAP_8BIT);
+  Serial.printf("MEM: heap %u free, %u low-water, %u largest block, %d blocks since setup\n",
+                (unsigned)heap.total_free_bytes, (unsigned)heap.minimum_free_bytes,
+                (unsigned)heap.largest_free_block, (int)heap.allocated_blocks - (int)heap_blocks_at_setup);
+
+  // Stack high-water marks are in bytes on the ESP32, the least ever left free
+  for (uint8_t i = 0; i < sizeof(tasks) / sizeof(tasks[0]); i++)
+  {
+    TaskHandle_t task = xTaskGetHandle(tasks[i]);
+    if (task != NULL)
+      Serial.printf("MEM: stack %-14s %5u bytes never used\n", tasks[i], (unsigned)uxTaskGetStackHighWaterMark(task));
+  }
+#else
+  Serial.printf("MEM: heap and task stacks are reported on the ESP32 only\n");
+#endif
+}
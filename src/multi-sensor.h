@@ -0,0 +1,66 @@
+//====================================================
+// setup_fusion_sensors: Probes the BMP280 on both I2C
+// addresses (0x76 and 0x77) and adds every new sensor
+// found to the fusion. Sensors already in the fusion are
+// set up again, which is the re-initialization after an
+// I2C fault. Returns the number of sensors that answered.
+//====================================================
+uint8_t setup_fusion_sensors(void)
+{
+  static Bmp280Forced *sensors[2] = {&sensor_alt, &sensor_std};
+  static bool added[2] = {false, false};
+  uint8_t found = 0;
+
+  for (uint8_t i = 0; i < 2; i++)
+  {
+    if (!sensors[i]->begin())
+      continue;
+    found++;
+    if (!added[i])
+    {
+      added[i] = fusion.add(sensors[i]);
+      Serial.printf("- BMP280 found at 0x%02X\n", sensors[i]->address());
+    }
+  }
+
+  return found;
+}
+
+//====================================================
+// read_fusion_sensors: One concurrent forced-mode
+// reading of all sensors. Returns temperature in
+// 1/100 C and pressure in Pa as the BME280 library
+// does, or 0 if no sensor answered.
+//====================================================
+int16_t read_fusion_sensors(int32_t &temp, int32_t &pressure)
+{
+  fusion_result fused;
+
+  if (!fusion.sample(fused))
+  {
+    Serial.printf("- No BMP280 reading, %d failed\n", fused.failed);
+    return 0;
+  }
+
+  temp = (int32_t)(fused.temp_c * 100.0);
+  pressure = (int32_t)fused.pressure_pa;
+
+  debug_fusion(fused);
+
+  return 1;
+}
+
+//====================================================
+// debug_fusion: Prints the fused reading, outliers and
+// learned sensor offsets to Arduino serial port.
+//====================================================
+void debug_fusion(fusion_result &fused)
+{
+  Serial.printf("FUS: %.2f Pa, %d used, %d rejected, %d failed, %u us", fused.pressure_pa, fused.used,
+                fused.rejected, fused.failed, (unsigned)fused.latency_us);
+  for (uint8_t i = 0; i < fusion.count(); i++)
+  {
+    Serial.printf(", off%d %.1f Pa", i, fusion.offset(i));
+  }
+  Serial.printf("\n");
+}
@@ -4,18 +4,19 @@
 #include <stdlib.h>
 #include <stdint.h>
 
-#define MINPRESSURE 997  // hPa/mbar
-#define MAXPRESSURE 1036 // hPa/mbar
+#define MINPRESSURE 995  // hPa/mbar
+#define MAXPRESSURE 1035 // hPa/mbar
 #define MAXHOURTIMESLOT 11
 
 int16_t *update_pressure_array(int16_t pressure_now);
-int16_t *map_pressure_values(int16_t *pressure_array);
-int16_t is_outside_range(int16_t *pressure_array);
+int16_t *map_pressure_values(int16_t *pressure_array, int16_t full_remap);
+int16_t select_pressure_window(int16_t *pressure_array);
 #endif
 
 //====================================================
 // update_pressure_array: Returns an updated pressure
-// reading in an MAXHOURTIMESLOT long array.
+// reading in an MAXHOURTIMESLOT long array, the
+// pressure_data hour slots allocated in setup_memory().
 //====================================================
 int16_t *update_pressure_array(int16_t pressure_now)
 {
@@ -31,111 +32,58 @@ int16_t *update_pressure_array(int16_t pressure_now)
     // Default pressure array at power start up
     // static int16_t pressure_data[MAXHOURTIMESLOT] = {MINPRESSURE, MINPRESSURE, MINPRESSURE, MINPRESSURE, MINPRESSURE, MINPRESSURE, MINPRESSURE, MINPRESSURE, MINPRESSURE, MINPRESSURE, MINPRESSURE};
     // static int16_t pressure_data[11] = {999, 1002, 1005, 1008, 1011, 1014, 1017, 1020, 1023, 1026, 1029};
-    static int16_t pressure_data[11] = {999, 1003, 1006, 1010, 1014, 1018, 1021, 1025, 1029, 1032, 1036};
+    // static int16_t pressure_data[11] = {999, 1003, 1006, 1010, 1014, 1018, 1021, 1025, 1029, 1032, 1036};
 
-    // Initial setup, shift out all previous pressure elements by one hour and add a new 'Now' pressure (at 0h) in pressure_data[0] position
-    for (int8_t i = MAXHOURTIMESLOT - 1; i > 0; i--)
-    {
-        pressure_data[i] = pressure_data[i - 1];
-    }
-    pressure_data[0] = pressure_now;
+    // Slot 0 is 'Now', the slots start flat at the first reading, see baro_shift_slots()
+    baro_shift_slots(pressure_data, MAXHOURTIMESLOT, pressure_now);
 
     return pressure_data;
 }
-int16_t fun1(int16_t input)
-{
-    static int16_t range_min = MINPRESSURE;
-    static int16_t range_max = MAXPRESSURE;
-    static int16_t range_len = 100;
-    static float range_delta = (range_max - range_min) / float(range_len);
-    int16_t output;
-
-    Serial.printf("TAW6 %f\n", range_delta);
-    // output = 100 - ((input - range_min) / range_delta);
-    output = ((input - range_min) / range_delta);
-    Serial.printf("TAW7 %d  %d\n", input, output);
-    // output = output + 10;
-    // output = 50;
-
-    return output;
-}
 //====================================================
-// map_pressure_values: Map actual pressure values in the
-// a pressure range [1003,1036] 'mbar' to fit scale.
+// map_pressure_values: Map actual pressure values into
+// the current scale window to fit the meter scales.
+// Call right after update_pressure_array(). Unless
+// full_remap is set (window moved, or first reading),
+// the mapped history is shifted one hour like the
+// pressure array and only the 'Now' value is mapped.
 //====================================================
-int16_t *map_pressure_values(int16_t *pressure_array)
+int16_t *map_pressure_values(int16_t *pressure_array, int16_t full_remap)
 {
+    pressure_window window = {range_min, range_max};
 
-    static int16_t meter_data[11] = {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0};
-    int8_t over_pressure = 0;
-    int8_t under_pressure = 0; // False
-    int16_t my_r;
-
-    for (int8_t i = 0; i < MAXHOURTIMESLOT; i++)
+    baro_map_slots(pressure_array, meter_data, MAXHOURTIMESLOT, window, full_remap);
+    for (int8_t i = 0; i < (full_remap ? MAXHOURTIMESLOT : 1); i++)
     {
-
-        my_r = fun1(pressure_array[i]);
-        meter_data[i] = my_r;
-        Serial.printf("TAW4 %d  %d\n", pressure_array[i], my_r);
+        Serial.printf("TAW4 %d  %d\n", pressure_array[i], meter_data[i]);
     }
 
     return meter_data;
 }
 
 //====================================================
-// is_outside_range: Verify if all pressure values
-// will fit on the meter scale (returns 0), or if any
-// single value is either to high or to low, and then
-// teturns 999 or -999 respectively. Returns 0 if
-// values span is greater than 2023 - 1003 = 20 'mbar'.
+// select_pressure_window: Auto-ranging of the six
+// scales. Keeps the scale window as long as the history
+// fits (hysteresis), otherwise centres a new window of
+// PRESSUREWINDOW 'mbar' on the history, snapped to
+// WINDOWSTEP. A history that fits into PRESSUREWINDOW
+// stays fully on the scale, or at least 'Now' does if
+// no window on the grid holds all of it. If the history
+// is wider than a window, the window follows 'Now' once
+// it gets within WINDOWMARGIN of an edge. Returns 1 if
+// the window moved, else 0.
 //====================================================
-
-int16_t is_outside_range(int16_t *pressure_array)
+int16_t select_pressure_window(int16_t *pressure_array)
 {
+    pressure_window window = {range_min, range_max};
 
-    int8_t over_pressure_flag = 0;  // false
-    int8_t under_pressure_flag = 0; // false
-
-    // Return the outside pressure element value as -999 or 999 or 0 for either,
-    // all elements in range, or find elements with over- and under-pressure at the same time.
-    for (int8_t i = 0; i < MAXHOURTIMESLOT; i++)
-    {
-
-        if (pressure_array[i] > MAXPRESSURE)
-        {
-            over_pressure_flag = 1;
-        }
-        if (pressure_array[i] < MINPRESSURE)
-        {
-            under_pressure_flag = 1;
-        }
-    }
-
-    if (over_pressure_flag && under_pressure_flag)
-    {
-#if MYDEBUG == 1
-        printf("\nis_outside_range(Detected both an over- and under pressure)");
-#endif
-        // NOP, cannot do anything if pressure values exceeds available range span
+    if (!baro_select_window(pressure_array, MAXHOURTIMESLOT, window, PRESSUREWINDOW, WINDOWSTEP, WINDOWMARGIN))
         return 0;
-    }
-    else if (over_pressure_flag || under_pressure_flag)
-    {
-        if (over_pressure_flag)
-        {
-#if MYDEBUG == 1
-            printf("\nis_outside_range(Detected over pressure value)");
-#endif
-            return 999;
-        }
-        if (under_pressure_flag)
-        {
+
 #if MYDEBUG == 1
-            printf("\nis_outside_range(Detected under pressure value)");
+    printf("\nselect_pressure_window(%d..%d -> %d..%d)", range_min, range_max, window.min, window.max);
 #endif
-            return -999;
-        }
-    }
+    range_min = window.min;
+    range_max = window.max;
 
-    return 0; // All values are mappable within pressure range
+    return 1;
 }
@@ -28,6 +28,31 @@ void setup_pressure_scales(const char *label, int x, int y)
   tft.drawCentreString("---", x + w / 2, y + 155 - 18, 2);
 }
 
+//====================================================
+// update_pressure_scale_labels: Writes the scale window
+// next to the long ticks of all six scales, as the last
+// two digits of 'mbar' (top, middle, bottom). Only
+// needed when the window moves.
+//====================================================
+void update_pressure_scale_labels(void)
+{
+  char buf[4];
+  int16_t label[3] = {range_max, (int16_t)((range_min + range_max) / 2), range_min};
+  int label_y[3] = {187 + 2, 187 + 52, 187 + 100 - 9};
+
+  tft.setTextColor(TFT_BLACK, TFT_WHITE);
+  tft.setTextFont(1);
+
+  for (int i = 0; i < 6; i++)
+  {
+    for (int j = 0; j < 3; j++)
+    {
+      sprintf(buf, "%02d", label[j] % 100);
+      tft.drawString(buf, i * 40 + 22, label_y[j], 1);
+    }
+  }
+}
+
 //====================================================
 // update_pressure_arrows: Draws the six small pressure
 // arrows on screen, and below the relative pressure vs.
@@ -57,7 +82,7 @@ void update_pressure_arrows(void)
 
     // Put text values, divide by 10, and refer to 'now' gives each a 'now'-difference in the scale marker in the small boxes below each scale
 
-    char buf[8];
+    char buf[12]; // Any int, values far off the window included
     dtostrf(value[i], 4, 0, buf);
     tft.drawRightString(buf, i * 40 + 36 - 5, 187 - 27 + 155 - 18, 2);
     Serial.printf("TAW5: %s %d\n", buf, value[i]);
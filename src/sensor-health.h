@@ -0,0 +1,94 @@
+//====================================================
+// setup_sensors: Sets up the pressure sensor(s), at
+// start-up and again after an I2C fault. Returns the
+// number of sensors that answered.
+//====================================================
+uint8_t setup_sensors(void)
+{
+#ifdef BME280
+  // while (!BME280.begin(I2C_STANDARD_MODE)) {
+  if (!BME280.begin(I2C_FAST_MODE_PLUS_MODE))
+    return 0;
+
+  BME280.mode(NormalMode);
+  BME280.setOversampling(TemperatureSensor, Oversample16);
+  BME280.setOversampling(HumiditySensor, Oversample16);
+  BME280.setOversampling(PressureSensor, Oversample16);
+  BME280.iirFilter(IIR16);
+  // BME280.setIIRFilter(IIR4);
+  // BME280.setGas(0, 0);        // 0,0 means no heated gas measurements
+  BME280.inactiveTime(inactive1000ms);
+
+  debug(F("- Setting 16x oversampling for all sensors\n"));
+  debug(F("- Setting IIR filter to a value of 4 samples\n"));
+  debug(F("\nTemp [C] Humid [RH%] Press [hPa/mbar] [min  sec]"));
+  debug(F("\n================================================\n"));
+  return 1;
+#else
+  // One or two BMP280 (0x76/0x77) in forced mode, x2 temp. and x16 pressure oversampling, no IIR filter lag.
+  // Two sensors convert concurrently and are fused, the fusion output filter keeps even one as quiet as IIR16.
+  return setup_fusion_sensors();
+#endif
+}
+
+//====================================================
+// read_sensors: One reading through the I2C health
+// layer. While the sensor is faulty the bus is left
+// alone until the next recovery attempt is due, which
+// clears the bus and sets the sensors up again first.
+// Returns 1 with temperature in 1/100 C, humidity and
+// pressure in Pa, or 0 if there is no good reading.
+//====================================================
+int16_t read_sensors(int32_t &temp, int32_t &humidity, int32_t &pressure)
+{
+  uint32_t start = millis();
+  bool was_healthy = i2c_health.healthy();
+  int16_t ok = 0;
+
+  if (!was_healthy)
+  {
+    if (!i2c_health.retry_due(start))
+      return 0; // Backing off
+
+    bool idle = i2c_health.clear_bus();
+    uint8_t found = idle ? setup_sensors() : 0;
+    Serial.printf("I2C: recovery attempt, %u SCL pulses, bus %s, %u sensor(s)\n", i2c_health.last_pulses(),
+                  idle ? "free" : "held low", found);
+    if (found == 0)
+    {
+      i2c_health.failure(millis(), millis() - start);
+      Serial.printf("I2C: next attempt in %u ms\n", i2c_health.retry_in(millis()));
+      return 0;
+    }
+  }
+
+  // A device holding SDA or SCL low would make every transfer run into the timeout, do not start one
+  if (i2c_health.bus_idle())
+  {
+#ifdef BME280
+    BME280.getSensorData(temp, humidity, pressure);
+    ok = 1;
+#else
+    ok = read_fusion_sensors(temp, pressure);
+    humidity = 12.3 * 100.0; // The BMP280 has no humidity sensor
+#endif
+  }
+
+  // A failed transfer can leave anything in the results, the sensors measure 300-1100 hPa and -40-85 C
+  ok = ok && pressure >= 30000 && pressure <= 110000 && temp >= -4000 && temp <= 8500;
+
+  if (ok)
+  {
+    i2c_health.success(millis(), millis() - start);
+    if (!was_healthy)
+      Serial.printf("I2C: recovered, %u ms without readings\n", i2c_health.stats().last_recovery_ms);
+  }
+  else
+  {
+    i2c_health.failure(millis(), millis() - start);
+    if (was_healthy)
+      Serial.printf("I2C: reading failed after %u ms, bus %s\n", millis() - start,
+                    i2c_health.bus_idle() ? "free" : "held low");
+  }
+  return ok;
+}
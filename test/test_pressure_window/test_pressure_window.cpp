@@ -0,0 +1,206 @@
+//====================================================
+// test_pressure_window: Auto-ranging of the six scales,
+// baro_select_window() as select_pressure_window() calls
+// it: 11 hour slots, 40 hPa window, 5 hPa grid and a
+// 2 hPa margin. 'Now' is slot 0.
+//
+// pio test -e native_test
+//====================================================
+
+#include <unity.h>
+#include <pressure_pipeline.h>
+
+#define SLOTS 11
+#define SPAN 40
+#define STEP 5
+#define MARGIN 2
+
+static pressure_window window;
+
+static void fill(int16_t *slots, int16_t value)
+{
+    for (uint8_t i = 0; i < SLOTS; i++)
+        slots[i] = value;
+}
+
+static void assert_window(int16_t min, int16_t max)
+{
+    TEST_ASSERT_EQUAL_INT16(min, window.min);
+    TEST_ASSERT_EQUAL_INT16(max, window.max);
+}
+
+void setUp(void)
+{
+    window.min = 995;
+    window.max = 1035;
+}
+
+void tearDown(void)
+{
+}
+
+void test_all_fit_keeps_window(void)
+{
+    int16_t slots[SLOTS];
+
+    fill(slots, 1013);
+    slots[3] = 995;  // On the edges still fits
+    slots[7] = 1035;
+    TEST_ASSERT_FALSE(baro_select_window(slots, SLOTS, window, SPAN, STEP, MARGIN));
+    assert_window(995, 1035);
+}
+
+void test_over_only_centres_on_history(void)
+{
+    int16_t slots[SLOTS];
+
+    fill(slots, 1030);
+    slots[5] = 1040; // Centre 1035, 1015 on the grid
+    TEST_ASSERT_TRUE(baro_select_window(slots, SLOTS, window, SPAN, STEP, MARGIN));
+    assert_window(1015, 1055);
+}
+
+void test_under_only_centres_on_history(void)
+{
+    int16_t slots[SLOTS];
+
+    fill(slots, 1000);
+    slots[0] = 990; // Centre 995, 975 on the grid
+    TEST_ASSERT_TRUE(baro_select_window(slots, SLOTS, window, SPAN, STEP, MARGIN));
+    assert_window(975, 1015);
+}
+
+void test_over_and_under_now_inside_margin_keeps_window(void)
+{
+    int16_t slots[SLOTS];
+
+    fill(slots, 1015);
+    slots[4] = 990;
+    slots[9] = 1040;
+    TEST_ASSERT_FALSE(baro_select_window(slots, SLOTS, window, SPAN, STEP, MARGIN));
+    assert_window(995, 1035);
+
+    slots[0] = 1033; // Exactly 'margin' from the edge is still inside
+    TEST_ASSERT_FALSE(baro_select_window(slots, SLOTS, window, SPAN, STEP, MARGIN));
+    slots[0] = 997;
+    TEST_ASSERT_FALSE(baro_select_window(slots, SLOTS, window, SPAN, STEP, MARGIN));
+    assert_window(995, 1035);
+}
+
+void test_over_and_under_now_in_margin_follows_now(void)
+{
+    int16_t slots[SLOTS];
+
+    fill(slots, 1015);
+    slots[4] = 990;
+    slots[9] = 1040;
+    slots[0] = 1034; // Centre on 'Now', 1014 snaps down to 1010
+    TEST_ASSERT_TRUE(baro_select_window(slots, SLOTS, window, SPAN, STEP, MARGIN));
+    assert_window(1010, 1050);
+
+    setUp();
+    slots[0] = 996; // 976 snaps down to 975
+    TEST_ASSERT_TRUE(baro_select_window(slots, SLOTS, window, SPAN, STEP, MARGIN));
+    assert_window(975, 1015);
+}
+
+void test_over_and_under_now_outside_follows_now(void)
+{
+    int16_t slots[SLOTS];
+
+    fill(slots, 1015);
+    slots[4] = 990;
+    slots[0] = 1042; // Both sides out, baro_outside_window() gives 0, 'Now' decides
+    TEST_ASSERT_TRUE(baro_select_window(slots, SLOTS, window, SPAN, STEP, MARGIN));
+    assert_window(1020, 1060);
+}
+
+void test_snaps_down_to_step_grid(void)
+{
+    int16_t slots[SLOTS];
+
+    fill(slots, 1044); // Centre 1044, 1024 snaps down to 1020
+    TEST_ASSERT_TRUE(baro_select_window(slots, SLOTS, window, SPAN, STEP, MARGIN));
+    assert_window(1020, 1060);
+
+    setUp();
+    fill(slots, 1045); // 1025 already on the grid
+    TEST_ASSERT_TRUE(baro_select_window(slots, SLOTS, window, SPAN, STEP, MARGIN));
+    assert_window(1025, 1065);
+}
+
+void test_snaps_down_below_zero(void)
+{
+    int16_t slots[SLOTS];
+
+    // C++ '%' truncates towards zero, -13 % 5 is -3, the window must still snap down to -15 and not up to -10
+    fill(slots, 7);
+    TEST_ASSERT_TRUE(baro_select_window(slots, SLOTS, window, SPAN, STEP, MARGIN));
+    assert_window(-15, 25);
+
+    setUp();
+    fill(slots, -20); // -40 already on the grid
+    TEST_ASSERT_TRUE(baro_select_window(slots, SLOTS, window, SPAN, STEP, MARGIN));
+    assert_window(-40, 0);
+}
+
+void test_history_of_span_width_stays_on_scale(void)
+{
+    int16_t slots[SLOTS];
+
+    fill(slots, 1020);
+    slots[3] = 1005;
+    slots[8] = 1044; // Centre 1024, 1004 snaps down to 1000 and would cut off 1044
+    TEST_ASSERT_TRUE(baro_select_window(slots, SLOTS, window, SPAN, STEP, MARGIN));
+    assert_window(1005, 1045);
+}
+
+void test_no_grid_fit_keeps_now_on_scale(void)
+{
+    int16_t slots[SLOTS];
+
+    window.min = 1020;
+    window.max = 1060;
+    fill(slots, 1030);
+    slots[2] = 1022;
+    slots[0] = 1062; // 40 hPa wide but off the grid, 1020..1060 would pin 'Now'
+    TEST_ASSERT_TRUE(baro_select_window(slots, SLOTS, window, SPAN, STEP, MARGIN));
+    assert_window(1025, 1065);
+
+    setUp();
+    fill(slots, 1020);
+    slots[4] = 1003;
+    slots[0] = 1041; // 38 hPa wide, no grid point in 1001..1003, 'Now' on top
+    TEST_ASSERT_TRUE(baro_select_window(slots, SLOTS, window, SPAN, STEP, MARGIN));
+    assert_window(1005, 1045);
+}
+
+void test_same_grid_point_is_not_a_move(void)
+{
+    int16_t slots[SLOTS];
+
+    window.min = 1000;
+    window.max = 1040;
+    fill(slots, 1020);
+    slots[4] = 1003;
+    slots[7] = 1041; // Over, but with 'Now' inside 1000..1040 is the window to keep, and it already has it
+    TEST_ASSERT_FALSE(baro_select_window(slots, SLOTS, window, SPAN, STEP, MARGIN));
+    assert_window(1000, 1040);
+}
+
+int main(void)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_all_fit_keeps_window);
+    RUN_TEST(test_over_only_centres_on_history);
+    RUN_TEST(test_under_only_centres_on_history);
+    RUN_TEST(test_over_and_under_now_inside_margin_keeps_window);
+    RUN_TEST(test_over_and_under_now_in_margin_follows_now);
+    RUN_TEST(test_over_and_under_now_outside_follows_now);
+    RUN_TEST(test_snaps_down_to_step_grid);
+    RUN_TEST(test_snaps_down_below_zero);
+    RUN_TEST(test_history_of_span_width_stays_on_scale);
+    RUN_TEST(test_no_grid_fit_keeps_now_on_scale);
+    RUN_TEST(test_same_grid_point_is_not_a_move);
+    return UNITY_END();
+}
@@ -0,0 +1,290 @@
+#include <math.h>
+#include <string.h>
+#include <adaptive_sampler.h>
+#include <time_weighted_mean.h>
+#include "fleet_log.h"
+
+static const char *parse_int(const char *p, const char *end, long &out)
+{
+    bool negative = false;
+    long v = 0;
+
+    while (p < end && *p == ' ')
+        p++;
+    if (p < end && *p == '-')
+    {
+        negative = true;
+        p++;
+    }
+    if (p >= end || *p < '0' || *p > '9')
+        return NULL;
+    while (p < end && *p >= '0' && *p <= '9')
+        v = v * 10 + (*p++ - '0');
+    out = negative ? -v : v;
+    return p;
+}
+
+//====================================================
+// parse_log_chunk: Appends the 'LOG:' records of the
+// whole lines in [begin, end) to out. Returns the
+// number of 'LOG:' lines that did not parse.
+//====================================================
+uint32_t parse_log_chunk(const char *begin, const char *end, std::vector<log_record> &out)
+{
+    uint32_t errors = 0;
+
+    for (const char *line = begin; line < end;)
+    {
+        const char *eol = (const char *)memchr(line, '\n', end - line);
+        if (eol == NULL)
+            eol = end;
+
+        const char *tag = (const char *)memmem(line, eol - line, "LOG:", 4);
+        if (tag != NULL)
+        {
+            long v[5];
+            const char *p = tag + 4;
+            int n = 0;
+            while (n < 5 && (p = parse_int(p, eol, v[n])) != NULL)
+                n++;
+            if (n == 5)
+                out.push_back({(uint32_t)v[0], (int32_t)v[1], (int32_t)v[2], (int32_t)v[3], (int16_t)v[4]});
+            else
+                errors++;
+        }
+        line = eol + 1;
+    }
+    return errors;
+}
+
+//====================================================
+// replay_device: Runs the records through the data path
+// as loop() does: sea level reduction, time weighted
+// hour mean, a slot shift at the first reading on or
+// after each hour of the session's one hour grid
+// (one_hour_done()), with one more shift per missed
+// hour, auto-ranging and the meter mapping. Writes one
+// line per shifting reading to hourly if given.
+//====================================================
+void replay_device(const record_chunks &chunks, device_summary &s, FILE *hourly)
+{
+    int16_t slots[MAXHOURTIMESLOT] = {0};
+    int16_t meter[MAXHOURTIMESLOT] = {0};
+    pressure_window window = {MINPRESSURE, MAXPRESSURE};
+    TimeWeightedMean hour_mean;
+    bool started = false, first = true;
+    uint32_t prev_ms = 0, session_shifts = 0;
+    uint64_t t = 0, next_shift = 0; // Session time [ms]
+    double prev_hpa = 0.0, area = 0.0, span = 0.0;
+
+    s.readings = s.sessions = s.shifts = s.window_moves = 0;
+    s.min_hpa = 1e9;
+    s.max_hpa = -1e9;
+    s.max_fall_3h = s.max_rise_3h = 0;
+
+    for (const std::vector<log_record> &chunk : chunks)
+    {
+        for (const log_record &r : chunk)
+        {
+            double sea = baro_sea_level(r.station_pa / 100.0, r.temp / 100.0, r.height);
+            float fpres = sea; // loop() keeps it as float
+            uint32_t dt = r.ms - prev_ms;
+
+            if (!started || (r.ms < prev_ms && dt > HOURSLOT_MS))
+            {
+                // First reading, or back in time further than a wrap of millis() within an hour: the unit rebooted
+                memset(slots, 0, sizeof(slots));
+                memset(meter, 0, sizeof(meter));
+                window = {MINPRESSURE, MAXPRESSURE};
+                hour_mean = TimeWeightedMean();
+                first = true;
+                t = next_shift = 0;
+                session_shifts = 0;
+                s.sessions++;
+                started = true;
+            }
+            else
+            {
+                t += dt;
+                area += 0.5 * (prev_hpa + sea) * dt;
+                span += dt;
+            }
+            prev_ms = r.ms;
+            prev_hpa = sea;
+
+            s.readings++;
+            if (sea < s.min_hpa)
+                s.min_hpa = sea;
+            if (sea > s.max_hpa)
+                s.max_hpa = sea;
+
+            hour_mean.add(r.ms, fpres);
+            if (!first && t < next_shift)
+                continue;
+
+            baro_shift_slots(slots, MAXHOURTIMESLOT, (int16_t)(first ? fpres : hour_mean.mean()));
+            s.shifts++;
+            session_shifts++;
+
+            // On the grid from the first reading, as next_shift_ms in loop(), one more shift per missed hour
+            next_shift = first ? t + HOURSLOT_MS : next_shift + HOURSLOT_MS;
+            bool missed = false;
+            while (next_shift <= t)
+            {
+                baro_shift_slots(slots, MAXHOURTIMESLOT, (int16_t)hour_mean.mean());
+                next_shift += HOURSLOT_MS;
+                s.shifts++;
+                session_shifts++;
+                missed = true;
+            }
+            hour_mean.restart();
+            bool moved = baro_select_window(slots, MAXHOURTIMESLOT, window, PRESSUREWINDOW, WINDOWSTEP, WINDOWMARGIN);
+            baro_map_slots(slots, meter, MAXHOURTIMESLOT, window, moved || first || missed);
+
+            if (moved && !first)
+                s.window_moves++;
+            if (session_shifts > 3)
+            {
+                int16_t tendency = slots[0] - slots[3];
+                if (tendency < s.max_fall_3h)
+                    s.max_fall_3h = tendency;
+                if (tendency > s.max_rise_3h)
+                    s.max_rise_3h = tendency;
+            }
+            if (hourly)
+                fprintf(hourly, "%u,%.3f,%d,%d,%d,%d,%d,%d,%d,%d,%d\n", s.sessions, t / 3600000.0, slots[0], window.min,
+                        window.max, meter[10], meter[8], meter[6], meter[3], meter[1], meter[0]);
+            first = false;
+        }
+    }
+
+    s.hours = span / 3600000.0;
+    s.mean_hpa = span > 0.0 ? area / span : prev_hpa;
+    s.window = window;
+    // The six scales as the display shows them, see value[] in loop()
+    static const uint8_t shown[6] = {10, 8, 6, 3, 1, 0};
+    for (int i = 0; i < 6; i++)
+        s.scales[i] = meter[shown[i]];
+}
+
+void print_summary_header(FILE *out)
+{
+    fprintf(out, "device,bytes,readings,errors,sessions,hours,shifts,window_moves,min_hpa,max_hpa,mean_hpa,"
+                 "max_fall_3h,max_rise_3h,window_min,window_max,scale_10h,scale_8h,scale_6h,scale_3h,scale_1h,"
+                 "scale_now\n");
+}
+
+void print_summary(FILE *out, const device_summary &s)
+{
+    fprintf(out, "%s,%llu,%u,%u,%u,%.2f,%u,%u,%.2f,%.2f,%.2f,%d,%d,%d,%d,%d,%d,%d,%d,%d,%d\n", s.name.c_str(),
+            (unsigned long long)s.bytes, s.readings, s.errors, s.sessions, s.hours, s.shifts, s.window_moves,
+            s.readings ? s.min_hpa : 0.0, s.readings ? s.max_hpa : 0.0, s.mean_hpa, s.max_fall_3h, s.max_rise_3h,
+            s.window.min, s.window.max, s.scales[0], s.scales[1], s.scales[2], s.scales[3], s.scales[4], s.scales[5]);
+}
+
+//====================================================
+// Synthetic logs for benchmarking, one unit: weather
+// drifting with random fronts, the semi-diurnal tide, a
+// daily temperature swing and the odd squall, sampled
+// by the firmware's adaptive sampler. Besides 'LOG:'
+// the other serial lines of loop() are written too, so
+// parsing sees realistic logs. Every third unit has
+// been up for 24.9 days when its log starts and loses
+// power a day later, the next ones wrap millis() a day
+// into the log.
+//====================================================
+
+static uint32_t lcg(uint32_t &state)
+{
+    state = state * 1664525u + 1013904223u;
+    return state >> 8;
+}
+
+static double uniform(uint32_t &state)
+{
+    return lcg(state) / 16777216.0;
+}
+
+uint64_t generate_device_log(const char *path, uint32_t seed, uint32_t days)
+{
+    FILE *f = fopen(path, "w");
+    uint32_t rng = seed * 2654435761u + 1;
+    AdaptiveSampler sampler;
+    uint32_t ms = 2000, next_shift;
+    double sim_s = 0.0, next_hour_s = 0.0, power_cut_s = -1.0;
+    double sea_hpa = 1000.0 + 25.0 * uniform(rng), slope_hpa_h = 0.0, squall_hpa = 0.0;
+    int height = 20 + lcg(rng) % 480;
+    int32_t pmin = 200000, pmax = 5;
+
+    if (f == NULL)
+        return 0;
+    setvbuf(f, NULL, _IOFBF, 1 << 20);
+
+    if (seed % 3 == 1)
+    {
+        ms = 0x80000000u; // Past the sign bit of millis(), the reboot still goes back in time
+        power_cut_s = 86400.0;
+    }
+    else if (seed % 3 == 2)
+        ms = 0u - 86400000u;
+    next_shift = ms + HOURSLOT_MS;
+
+    while (sim_s < days * 86400.0)
+    {
+        if (sim_s >= next_hour_s)
+        {
+            // New trend every hour, pulled back towards 1013 hPa
+            slope_hpa_h = 0.9 * slope_hpa_h + 0.8 * (uniform(rng) - 0.5) + 0.005 * (1013.0 - sea_hpa);
+            if (uniform(rng) < 0.005)
+                squall_hpa = 2.0 + 2.0 * uniform(rng);
+            next_hour_s += 3600.0;
+        }
+
+        double tide = 1.0 * sin(2.0 * M_PI * sim_s / 43200.0);
+        double temp_c = 12.0 + 6.0 * sin(2.0 * M_PI * (sim_s / 86400.0 - 0.3)) + 0.2 * (uniform(rng) - 0.5);
+        double sea = sea_hpa + tide + squall_hpa;
+        double factor = pow(1.0 - 0.0065 * height / (temp_c + 0.0065 * height + 273.15), 5.25588);
+        double noise = 0.0075 * (uniform(rng) + uniform(rng) + uniform(rng) - 1.5) * 2.0;
+        int32_t station = (int32_t)((sea * factor + noise) * 100.0);
+        int32_t temp = (int32_t)(temp_c * 100.0);
+        double reduced = baro_sea_level(station / 100.0, temp / 100.0, height);
+        int32_t pressure = (int32_t)(reduced * 100.0);
+
+        if (pressure > pmax)
+            pmax = pressure;
+        if (pressure < pmin)
+            pmin = pressure;
+
+        fprintf(f, "FUS: %.2f Pa, 2 used, 0 rejected, 0 failed, 37512 us, off0 -0.4 Pa, off1 0.4 Pa\n",
+                station + 200.0);
+        fprintf(f, "LOG: %u %d %d 1230 %d\n", ms, station, temp, height);
+        fprintf(f, "TAW: %.3f %.3f %.3f %.3d  %3d.%02d  12.300 %5d.%02d   %d  %d [C], [%%RH], [mbar] [min  sec]\n",
+                station / 100.0, reduced - station / 100.0, reduced, pressure, temp / 100, temp % 100,
+                pressure / 100, pressure % 100, (int)(sim_s / 60) % 60, (int)sim_s % 60);
+        fprintf(f, "TAW2: %4d, %4d\n  %8.2f mb\n", pmin, pmax, reduced);
+
+        uint32_t interval = sampler.update(ms, pressure);
+        if ((int32_t)(ms - next_shift) >= 0)
+            next_shift += HOURSLOT_MS;
+        if (interval > next_shift - ms)
+            interval = next_shift - ms; // The firmware reads on the hour slot shift, see loop()
+        sim_s += (interval + 40) / 1000.0; // Reading and drawing take ~40 ms
+        ms += interval + 40;
+        sea_hpa += slope_hpa_h * (interval + 40) / 3600000.0;
+        squall_hpa *= exp(-(interval + 40.0) / 3600000.0);
+
+        if (lcg(rng) % 100000 == 0 || (power_cut_s >= 0.0 && sim_s >= power_cut_s))
+        {
+            // Brown-out, the unit starts over
+            fprintf(f, "- BMP280 found at 0x76\n- BMP280 found at 0x77\n");
+            ms = 2000;
+            next_shift = ms + HOURSLOT_MS;
+            sampler = AdaptiveSampler();
+            power_cut_s = -1.0;
+        }
+    }
+
+    uint64_t size = (uint64_t)ftell(f);
+    fclose(f);
+    return size;
+}
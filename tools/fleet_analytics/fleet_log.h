@@ -0,0 +1,61 @@
+#ifndef FLEET_LOG_H
+#define FLEET_LOG_H
+
+//====================================================
+// fleet_log: Serial logs of one barometer, parsed and
+// replayed through the firmware's data path.
+//
+// Only 'LOG:' lines are used, anything else the
+// firmware prints (or a log collector prefixes) is
+// skipped:
+//
+//   LOG: <millis> <station Pa> <temp 1/100 C> <humidity> <height m>
+//
+// millis() wrapping after 49.7 days is followed, a
+// jump back in time starts a new session (reboot) with
+// a fresh pipeline, like the unit itself.
+//====================================================
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string>
+#include <vector>
+#include <pressure_pipeline.h>
+
+struct log_record
+{
+    uint32_t ms;
+    int32_t station_pa;
+    int32_t temp;     // 1/100 C
+    int32_t humidity; // As the sensor reports it
+    int16_t height;   // m
+};
+
+struct device_summary
+{
+    std::string name;
+    uint64_t bytes;
+    uint32_t readings;
+    uint32_t errors; // 'LOG:' lines that did not parse
+    uint32_t sessions;
+    uint32_t shifts;       // Hour slot shifts
+    uint32_t window_moves; // Scale window moves after the first reading of a session
+    double hours;          // Time covered by readings
+    double min_hpa;        // Sea level
+    double max_hpa;
+    double mean_hpa; // Time weighted
+    int16_t max_fall_3h; // 'Now' vs. -3h slot, hPa
+    int16_t max_rise_3h;
+    pressure_window window; // At the end of the log
+    int16_t scales[6];      // The six scales at the end, [0,100], -10h ... Now
+};
+
+typedef std::vector<std::vector<log_record>> record_chunks;
+
+uint32_t parse_log_chunk(const char *begin, const char *end, std::vector<log_record> &out);
+void replay_device(const record_chunks &chunks, device_summary &summary, FILE *hourly);
+void print_summary_header(FILE *out);
+void print_summary(FILE *out, const device_summary &s);
+uint64_t generate_device_log(const char *path, uint32_t seed, uint32_t days);
+
+#endif
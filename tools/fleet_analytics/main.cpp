@@ -0,0 +1,326 @@
+//====================================================
+// fleet_analytics: Reprocesses the serial logs of many
+// barometers with the firmware's own data path (sea
+// level reduction, hour slots, auto-ranging, meter
+// mapping from lib/barometer_core) and writes one
+// summary line per unit.
+//
+// Usage: fleet_analytics [-j threads] [-c chunk KB] [-o dir] [-S] log...
+//        fleet_analytics -g units [-d days] dir
+//
+//   -j  worker threads (default: all cores)
+//   -c  logs are parsed in chunks of this size, so a
+//       few big logs spread over all threads too
+//       (default 1024 KB)
+//   -o  write summary.csv and <unit>.hourly.csv (every
+//       slot shift: slot, window, the six scales) to dir,
+//       otherwise the summary goes to stdout
+//   -S  scaling run: the same logs with 1, 2, 4 ...
+//       threads, reports throughput and speedup
+//   -g  write synthetic logs of this many units to dir
+//   -d  days per synthetic log (default 30)
+//
+// Every chunk is a task on a work-stealing thread pool.
+// The last chunk of a log to finish queues the replay of
+// that log, which is sequential per unit.
+//====================================================
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <fcntl.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "fleet_log.h"
+#include "work_stealing_pool.h"
+
+struct device_job
+{
+    std::string path;
+    const char *data;
+    size_t size;
+    record_chunks chunks;
+    std::vector<uint32_t> errors;
+    std::atomic<unsigned> left; // Chunks still parsing
+    device_summary summary;
+    FILE *hourly;
+};
+
+struct run_stats
+{
+    double seconds;
+    uint64_t bytes;
+    uint64_t readings;
+    uint64_t steals;
+};
+
+static double wall_s(void)
+{
+    using namespace std::chrono;
+    return duration<double>(steady_clock::now().time_since_epoch()).count();
+}
+
+static bool map_log(device_job &job)
+{
+    struct stat st;
+    int fd = open(job.path.c_str(), O_RDONLY);
+
+    if (fd < 0 || fstat(fd, &st) < 0)
+    {
+        if (fd >= 0)
+            close(fd);
+        return false;
+    }
+    job.size = st.st_size;
+    job.data = NULL;
+    if (job.size > 0)
+    {
+        void *p = mmap(NULL, job.size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (p == MAP_FAILED)
+        {
+            close(fd);
+            return false;
+        }
+        madvise(p, job.size, MADV_SEQUENTIAL);
+        job.data = (const char *)p;
+    }
+    close(fd);
+
+    std::string base = job.path.substr(job.path.find_last_of('/') + 1);
+    job.summary.name = base.substr(0, base.find('.'));
+    job.summary.bytes = job.size;
+    return true;
+}
+
+static void replay(device_job &job)
+{
+    replay_device(job.chunks, job.summary, job.hourly);
+    job.summary.errors = 0;
+    for (uint32_t e : job.errors)
+        job.summary.errors += e;
+    job.chunks.clear(); // Records are not needed any more
+    job.chunks.shrink_to_fit();
+}
+
+//====================================================
+// analyse: Parses and replays all logs on a pool of
+// 'threads' workers. Chunk edges move to the next line
+// start, so every line is parsed by exactly one task.
+//====================================================
+static run_stats analyse(std::vector<std::unique_ptr<device_job>> &jobs, unsigned threads, size_t chunk_bytes)
+{
+    run_stats stats = {};
+    double t0 = wall_s();
+    {
+        WorkStealingPool pool(threads);
+
+        for (auto &j : jobs)
+        {
+            device_job &job = *j;
+            std::vector<size_t> edges(1, 0);
+
+            while (edges.back() < job.size)
+            {
+                size_t e = std::min(edges.back() + chunk_bytes, job.size);
+                const char *nl = e < job.size ? (const char *)memchr(job.data + e, '\n', job.size - e) : NULL;
+                edges.push_back(nl ? (size_t)(nl - job.data) + 1 : job.size);
+            }
+
+            size_t n = edges.size() - 1;
+            job.chunks.assign(n, std::vector<log_record>());
+            job.errors.assign(n, 0);
+            job.left = (unsigned)n;
+            stats.bytes += job.size;
+
+            if (n == 0)
+            {
+                pool.submit([&job]() { replay(job); });
+                continue;
+            }
+            for (size_t i = 0; i < n; i++)
+            {
+                size_t begin = edges[i], end = edges[i + 1];
+                pool.submit([&job, &pool, i, begin, end]() {
+                    job.chunks[i].reserve((end - begin) / 200);
+                    job.errors[i] = parse_log_chunk(job.data + begin, job.data + end, job.chunks[i]);
+                    if (--job.left == 0)
+                        pool.submit([&job]() { replay(job); });
+                });
+            }
+        }
+
+        pool.wait();
+        stats.steals = pool.steals();
+    }
+    stats.seconds = wall_s() - t0;
+    for (auto &j : jobs)
+        stats.readings += j->summary.readings;
+    return stats;
+}
+
+static void print_stats(FILE *out, size_t logs, unsigned threads, const run_stats &s)
+{
+    fprintf(out, "%zu logs, %.1f MB, %llu readings, %u threads: %.3f s, %.1f MB/s, %.2f M readings/s, %llu steals\n",
+            logs, s.bytes / 1e6, (unsigned long long)s.readings, threads, s.seconds, s.bytes / 1e6 / s.seconds,
+            s.readings / 1e6 / s.seconds, (unsigned long long)s.steals);
+}
+
+static int generate(const char *dir, unsigned units, unsigned days, unsigned threads)
+{
+    std::atomic<uint64_t> bytes(0);
+    double t0 = wall_s();
+
+    mkdir(dir, 0755);
+    {
+        WorkStealingPool pool(threads);
+        for (unsigned u = 0; u < units; u++)
+        {
+            pool.submit([dir, u, days, &bytes]() {
+                char path[512];
+                snprintf(path, sizeof(path), "%s/baro%03u.log", dir, u);
+                bytes += generate_device_log(path, u, days);
+            });
+        }
+        pool.wait();
+    }
+    fprintf(stderr, "%u synthetic logs of %u days, %.1f MB in %s, %.2f s\n", units, days, bytes / 1e6, dir,
+            wall_s() - t0);
+    return 0;
+}
+
+static void usage(const char *name)
+{
+    fprintf(stderr,
+            "Usage: %s [-j threads] [-c chunk KB] [-o dir] [-S] log...\n"
+            "       %s -g units [-d days] dir\n",
+            name, name);
+}
+
+int main(int argc, char **argv)
+{
+    unsigned threads = std::max(1u, std::thread::hardware_concurrency());
+    size_t chunk_bytes = 1024 * 1024;
+    const char *out_dir = NULL;
+    unsigned units = 0, days = 30;
+    bool scaling = false;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "j:c:o:Sg:d:h")) != -1)
+    {
+        switch (opt)
+        {
+        case 'j':
+            threads = std::max(1, atoi(optarg));
+            break;
+        case 'c':
+            chunk_bytes = std::max(4, atoi(optarg)) * (size_t)1024;
+            break;
+        case 'o':
+            out_dir = optarg;
+            break;
+        case 'S':
+            scaling = true;
+            break;
+        case 'g':
+            units = atoi(optarg);
+            break;
+        case 'd':
+            days = std::max(1, atoi(optarg));
+            break;
+        default:
+            usage(argv[0]);
+            return 2;
+        }
+    }
+
+    if (units > 0)
+    {
+        if (optind != argc - 1)
+        {
+            usage(argv[0]);
+            return 2;
+        }
+        return generate(argv[optind], units, days, threads);
+    }
+    if (optind >= argc)
+    {
+        usage(argv[0]);
+        return 2;
+    }
+
+    std::vector<std::unique_ptr<device_job>> jobs;
+    for (int i = optind; i < argc; i++)
+    {
+        std::unique_ptr<device_job> job(new device_job);
+        job->path = argv[i];
+        job->hourly = NULL;
+        if (!map_log(*job))
+        {
+            fprintf(stderr, "Cannot read %s\n", argv[i]);
+            return 1;
+        }
+        jobs.push_back(std::move(job));
+    }
+
+    if (scaling)
+    {
+        double base = 0.0;
+        analyse(jobs, threads, chunk_bytes); // Warm up the page cache
+        printf("%8s %10s %10s %12s %8s %10s\n", "threads", "seconds", "MB/s", "readings/s", "speedup", "efficiency");
+        for (unsigned n = 1;; n = std::min(n * 2, threads))
+        {
+            run_stats s = analyse(jobs, n, chunk_bytes);
+            if (n == 1)
+                base = s.seconds;
+            printf("%8u %10.3f %10.1f %12.0f %8.2f %9.0f%%\n", n, s.seconds, s.bytes / 1e6 / s.seconds,
+                   s.readings / s.seconds, base / s.seconds, 100.0 * base / s.seconds / n);
+            if (n == threads)
+                break;
+        }
+        return 0;
+    }
+
+    FILE *summary = stdout;
+    if (out_dir)
+    {
+        char path[1024];
+        mkdir(out_dir, 0755);
+        snprintf(path, sizeof(path), "%s/summary.csv", out_dir);
+        summary = fopen(path, "w");
+        if (summary == NULL)
+        {
+            fprintf(stderr, "Cannot write %s\n", path);
+            return 1;
+        }
+        for (auto &job : jobs)
+        {
+            snprintf(path, sizeof(path), "%s/%s.hourly.csv", out_dir, job->summary.name.c_str());
+            job->hourly = fopen(path, "w");
+            if (job->hourly)
+                fprintf(job->hourly, "session,hours,slot_hpa,window_min,window_max,scale_10h,scale_8h,scale_6h,"
+                                     "scale_3h,scale_1h,scale_now\n");
+        }
+    }
+
+    run_stats stats = analyse(jobs, threads, chunk_bytes);
+
+    uint32_t errors = 0;
+    print_summary_header(summary);
+    for (auto &job : jobs)
+    {
+        print_summary(summary, job->summary);
+        errors += job->summary.errors;
+        if (job->hourly)
+            fclose(job->hourly);
+    }
+    if (summary != stdout)
+        fclose(summary);
+
+    print_stats(stderr, jobs.size(), threads, stats);
+    if (errors > 0)
+        fprintf(stderr, "%u malformed LOG: lines skipped\n", errors);
+    return 0;
+}
@@ -0,0 +1,110 @@
+#include "work_stealing_pool.h"
+
+static thread_local WorkStealingPool *current_pool = nullptr;
+static thread_local unsigned current_index = 0;
+
+WorkStealingPool::WorkStealingPool(unsigned threads) : _queued(0), _pending(0), _next(0), _steals(0), _stop(false)
+{
+    if (threads == 0)
+        threads = 1;
+    for (unsigned i = 0; i < threads; i++)
+        _queues.emplace_back(new queue);
+    for (unsigned i = 0; i < threads; i++)
+        _workers.emplace_back(&WorkStealingPool::run, this, i);
+}
+
+WorkStealingPool::~WorkStealingPool()
+{
+    {
+        std::lock_guard<std::mutex> lk(_idle_lock);
+        _stop = true;
+    }
+    _idle.notify_all();
+    for (auto &w : _workers)
+        w.join();
+}
+
+void WorkStealingPool::submit(task t)
+{
+    unsigned index = current_pool == this ? current_index : _next++ % threads();
+
+    _pending++;
+    {
+        std::lock_guard<std::mutex> lk(_queues[index]->lock);
+        _queues[index]->tasks.push_back(std::move(t));
+    }
+    {
+        std::lock_guard<std::mutex> lk(_idle_lock);
+        _queued++;
+    }
+    _idle.notify_one();
+}
+
+void WorkStealingPool::wait(void)
+{
+    std::unique_lock<std::mutex> lk(_idle_lock);
+    _done.wait(lk, [this]() { return _pending == 0; });
+}
+
+//====================================================
+// pop: Newest task of the own deque, else the oldest of
+// the next non-empty deque after it.
+//====================================================
+bool WorkStealingPool::pop(unsigned index, task &t)
+{
+    unsigned n = threads();
+
+    for (unsigned k = 0; k < n; k++)
+    {
+        queue &q = *_queues[(index + k) % n];
+        std::lock_guard<std::mutex> lk(q.lock);
+        if (q.tasks.empty())
+            continue;
+        if (k == 0)
+        {
+            t = std::move(q.tasks.back());
+            q.tasks.pop_back();
+        }
+        else
+        {
+            t = std::move(q.tasks.front());
+            q.tasks.pop_front();
+            _steals++;
+        }
+        return true;
+    }
+    return false;
+}
+
+void WorkStealingPool::run(unsigned index)
+{
+    current_pool = this;
+    current_index = index;
+
+    for (;;)
+    {
+        task t;
+        {
+            std::unique_lock<std::mutex> lk(_idle_lock);
+            _idle.wait(lk, [this]() { return _queued > 0 || _stop; });
+            if (_queued == 0)
+                return; // Stopped and drained
+            _queued--; // Claims one task, every claim has a task waiting in some deque
+        }
+
+        if (!pop(index, t))
+        {
+            std::lock_guard<std::mutex> lk(_idle_lock);
+            _queued++; // Should not happen, give the claim back
+            continue;
+        }
+
+        t();
+
+        if (--_pending == 0)
+        {
+            std::lock_guard<std::mutex> lk(_idle_lock);
+            _done.notify_all();
+        }
+    }
+}
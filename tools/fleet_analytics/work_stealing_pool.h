@@ -0,0 +1,59 @@
+#ifndef WORK_STEALING_POOL_H
+#define WORK_STEALING_POOL_H
+
+//====================================================
+// work_stealing_pool: Fixed set of worker threads, one
+// task deque each. A worker runs its own tasks newest
+// first (warm caches for tasks it spawned itself) and,
+// when it runs dry, steals the oldest task of another
+// worker. Tasks may submit more tasks; wait() returns
+// once all of them are done.
+//====================================================
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class WorkStealingPool
+{
+public:
+    typedef std::function<void(void)> task;
+
+    explicit WorkStealingPool(unsigned threads);
+    ~WorkStealingPool();
+
+    void submit(task t); // From a worker: its own deque, else round robin
+    void wait(void);
+
+    unsigned threads(void) const { return (unsigned)_queues.size(); }
+    uint64_t steals(void) const { return _steals; }
+
+private:
+    struct queue
+    {
+        std::mutex lock;
+        std::deque<task> tasks;
+    };
+
+    void run(unsigned index);
+    bool pop(unsigned index, task &t);
+
+    std::vector<std::unique_ptr<queue>> _queues;
+    std::vector<std::thread> _workers;
+
+    std::mutex _idle_lock;
+    std::condition_variable _idle; // Workers wait here for queued tasks
+    std::condition_variable _done; // wait() waits here for pending == 0
+    size_t _queued;                // Tasks in the deques, under _idle_lock
+    std::atomic<size_t> _pending;  // Submitted and not finished
+    std::atomic<unsigned> _next;
+    std::atomic<uint64_t> _steals;
+    bool _stop;
+};
+
+#endif
@@ -0,0 +1,201 @@
+//====================================================
+// fusion_bench: Compares one heavily oversampled BMP280
+// with forced-mode sensor fusion, on the simulated noisy
+// BMP280 fakes of lib/host_emulator (virtual clock).
+//
+// Every configuration is sampled once a second for 10
+// minutes. The trace is flat, then steps -2 hPa at 5 min
+// (a fast drop). Reported per configuration:
+//
+//   noise    rms deviation during the flat part [Pa]
+//   bias     mean error vs. the trace [Pa]
+//   latency  trigger to result per sample [ms]
+//   lag      step to 90% of the step in the output [s]
+//   glitch   max error with +3 hPa spikes on 2% of the
+//            0x77 readings, and how many were rejected
+//
+// Sensor 0x76 reads 20 Pa low and 0x77 30 Pa high.
+// The baseline is the configuration the firmware used
+// to ship, one sensor in normal mode with IIR16. The
+// fusion output filter must reach its noise without its
+// lag. Exits 1 if the fused output of one or two x16
+// sensors is noisier than the baseline, two are not
+// quieter than one at the same latency, do not follow
+// the step faster than the baseline, or let a spike
+// through.
+//====================================================
+
+#include <Arduino.h>
+#include <Adafruit_BMP280.h>
+#include <sensor_fusion.h>
+#include <bmp280_forced.h>
+
+#define BENCH_SECONDS 600
+#define BENCH_STEP_S 300
+#define BENCH_SETTLE_S 60
+#define BENCH_BASE_PA 99800.0f
+#define BENCH_STEP_PA -200.0f
+
+struct bench_result
+{
+    float noise_pa;
+    float bias_pa;
+    float latency_ms;
+    float lag_s;
+    float glitch_max_pa;
+    uint32_t rejected;
+};
+
+static uint32_t step_at_ms = 0;
+
+static float bench_trace(uint32_t ms)
+{
+    return (ms >= step_at_ms) ? BENCH_BASE_PA + BENCH_STEP_PA : BENCH_BASE_PA;
+}
+
+//====================================================
+// bench_source: Either the old normal mode sensor with
+// IIR filter, or a fusion of forced-mode sensors.
+//====================================================
+struct bench_source
+{
+    Adafruit_BMP280 *normal;
+    SensorFusion *fusion;
+    uint32_t latency_us;
+    uint32_t rejected;
+
+    bool read(float &pressure_pa)
+    {
+        if (normal)
+        {
+            pressure_pa = normal->readPressure();
+            latency_us = 0;
+            return !isnan(pressure_pa);
+        }
+        fusion_result r;
+        if (!fusion->sample(r))
+            return false;
+        pressure_pa = r.pressure_pa;
+        latency_us = r.latency_us;
+        rejected += r.rejected;
+        return true;
+    }
+};
+
+static void run_trace(bench_source &src, float *out, uint32_t *latency)
+{
+    uint32_t t0 = millis();
+    step_at_ms = t0 + BENCH_STEP_S * 1000u;
+
+    for (int s = 0; s < BENCH_SECONDS; s++)
+    {
+        uint32_t due = t0 + s * 1000u;
+        if ((int32_t)(due - millis()) > 0)
+            delay(due - millis());
+        if (!src.read(out[s]))
+            out[s] = NAN;
+        latency[s] = src.latency_us;
+    }
+}
+
+static bench_result measure(bench_source &src)
+{
+    static float p[BENCH_SECONDS];
+    static uint32_t lat[BENCH_SECONDS];
+    bench_result r = {};
+    double sum = 0.0, sum2 = 0.0, sum_lat = 0.0;
+    int n = 0;
+
+    Adafruit_BMP280::setGlitch(BMP280_ADDRESS, 0.0f, 0.0f);
+    run_trace(src, p, lat);
+
+    for (int s = BENCH_SETTLE_S; s < BENCH_STEP_S; s++)
+    {
+        sum += p[s];
+        sum2 += (double)p[s] * p[s];
+        sum_lat += lat[s];
+        n++;
+    }
+    double mean = sum / n;
+    r.noise_pa = (float)sqrt(sum2 / n - mean * mean);
+    r.bias_pa = (float)(mean - BENCH_BASE_PA);
+    r.latency_ms = (float)(sum_lat / n / 1000.0);
+
+    r.lag_s = NAN;
+    for (int s = BENCH_STEP_S; s < BENCH_SECONDS; s++)
+    {
+        if (p[s] - mean <= 0.9f * BENCH_STEP_PA)
+        {
+            r.lag_s = (float)(s - BENCH_STEP_S);
+            break;
+        }
+    }
+
+    Adafruit_BMP280::setGlitch(BMP280_ADDRESS, 0.02f, 300.0f);
+    src.rejected = 0;
+    run_trace(src, p, lat);
+    for (int s = BENCH_SETTLE_S; s < BENCH_STEP_S; s++)
+    {
+        float e = fabsf(p[s] - (float)mean);
+        if (e > r.glitch_max_pa)
+            r.glitch_max_pa = e;
+    }
+    r.rejected = src.rejected;
+    Adafruit_BMP280::setGlitch(BMP280_ADDRESS, 0.0f, 0.0f);
+
+    return r;
+}
+
+static void print_result(const char *name, const bench_result &r)
+{
+    printf("%-30s %8.2f %8.2f %10.2f %8.0f %12.1f %9u\n", name, r.noise_pa, r.bias_pa, r.latency_ms, r.lag_s,
+           r.glitch_max_pa, r.rejected);
+}
+
+static bench_result bench_fusion(const char *name, uint8_t sensors, Adafruit_BMP280::sensor_sampling press_os)
+{
+    Bmp280Forced s76(BMP280_ADDRESS_ALT, Adafruit_BMP280::SAMPLING_X2, press_os);
+    Bmp280Forced s77(BMP280_ADDRESS, Adafruit_BMP280::SAMPLING_X2, press_os);
+    SensorFusion fusion;
+
+    // Single sensor runs on 0x77, the one that gets the spikes
+    if (sensors > 1 && s76.begin())
+        fusion.add(&s76);
+    if (s77.begin())
+        fusion.add(&s77);
+
+    bench_source src = {NULL, &fusion, 0, 0};
+    bench_result r = measure(src);
+    print_result(name, r);
+    return r;
+}
+
+int main(void)
+{
+    Serial.setOutput(NULL);
+    Adafruit_BMP280::setTrace(bench_trace, NULL);
+    Adafruit_BMP280::setBias(BMP280_ADDRESS_ALT, -20.0f);
+    Adafruit_BMP280::setBias(BMP280_ADDRESS, 30.0f);
+
+    printf("%-30s %8s %8s %10s %8s %12s %9s\n", "configuration", "noise", "bias", "latency", "lag", "glitch max",
+           "rejected");
+
+    Adafruit_BMP280 old;
+    old.begin(BMP280_ADDRESS);
+    old.setSampling(Adafruit_BMP280::MODE_NORMAL, Adafruit_BMP280::SAMPLING_X2, Adafruit_BMP280::SAMPLING_X16,
+                    Adafruit_BMP280::FILTER_X16, Adafruit_BMP280::STANDBY_MS_500);
+    bench_source src = {&old, NULL, 0, 0};
+    bench_result shipped = measure(src);
+    print_result("1x normal x16, IIR16", shipped);
+
+    bench_result one = bench_fusion("1x forced x16", 1, Adafruit_BMP280::SAMPLING_X16);
+    bench_result two = bench_fusion("2x forced x16, fused", 2, Adafruit_BMP280::SAMPLING_X16);
+    bench_fusion("2x forced x8, fused", 2, Adafruit_BMP280::SAMPLING_X8);
+
+    bool pass = two.noise_pa <= shipped.noise_pa && one.noise_pa <= shipped.noise_pa && two.noise_pa < one.noise_pa &&
+                two.latency_ms <= one.latency_ms * 1.1f && two.lag_s < shipped.lag_s && two.glitch_max_pa < 50.0f;
+    printf("\n%s: fused lag %.0f s vs %.0f s shipped (IIR16), noise %.2f Pa vs %.2f Pa shipped and %.2f Pa single\n",
+           pass ? "PASS" : "FAIL", two.lag_s, shipped.lag_s, two.noise_pa, shipped.noise_pa, one.noise_pa);
+
+    return pass ? 0 : 1;
+}
@@ -0,0 +1,399 @@
+//====================================================
+// http_loadtest: Loopback load test of the /history and
+// /live endpoints. The server runs exactly as in the
+// firmware (HistoryHttpServer polled from one thread) on
+// the POSIX socket transport, the clients are threads.
+//
+//   history  -c threads each fetch /history -r times,
+//            json, csv and bin in turn, decode the
+//            chunked body and check every record
+//   live     -l threads read /live for -d seconds,
+//            reconnect with Last-Event-ID and check the
+//            ids carry on without a gap
+//
+// A producer pushes a sample every -p ms meanwhile. More
+// threads than connection slots exercise the 503 path,
+// turned away clients retry. Reports requests/s, MB/s,
+// latency percentiles and the server RAM. Exits 1 on any
+// protocol error.
+//====================================================
+
+#include <Arduino.h>
+#include <sample_history.h>
+#include <history_http.h>
+#include <posix_transport.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#define LOAD_HISTORY 720
+
+struct client_result
+{
+    uint32_t requests;
+    uint32_t busy;
+    uint32_t errors;
+    uint64_t bytes;
+    uint32_t events;
+    double done_ms;
+    std::vector<float> latency_ms;
+};
+
+static uint16_t server_port;
+static std::atomic<bool> stop_server(false);
+
+static double wall_ms(void)
+{
+    using namespace std::chrono;
+    return duration<double, std::milli>(steady_clock::now().time_since_epoch()).count();
+}
+
+static int connect_server(void)
+{
+    struct sockaddr_in addr = {};
+    struct timeval tv = {5, 0};
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(server_port);
+    inet_pton(AF_INET, "127.0.0.1", &addr.sin_addr);
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+    if (connect(fd, (struct sockaddr *)&addr, sizeof(addr)) < 0)
+    {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+static bool send_all(int fd, const std::string &s)
+{
+    return send(fd, s.data(), s.size(), MSG_NOSIGNAL) == (ssize_t)s.size();
+}
+
+// Reads until the server closes, false on timeout
+static bool read_all(int fd, std::string &out)
+{
+    char buf[4096];
+    ssize_t n;
+
+    while ((n = recv(fd, buf, sizeof(buf), 0)) > 0)
+        out.append(buf, n);
+    return n == 0;
+}
+
+static bool dechunk(const std::string &body, std::string &out)
+{
+    size_t pos = 0;
+
+    for (;;)
+    {
+        size_t eol = body.find("\r\n", pos);
+        if (eol == std::string::npos)
+            return false;
+        size_t len = strtoul(body.c_str() + pos, NULL, 16);
+        pos = eol + 2;
+        if (len == 0)
+            return body.compare(pos, 2, "\r\n") == 0;
+        if (pos + len + 2 > body.size() || body.compare(pos + len, 2, "\r\n") != 0)
+            return false;
+        out.append(body, pos, len);
+        pos += len + 2;
+    }
+}
+
+//====================================================
+// check_records: Decodes the body of a /history response
+// and checks sequence numbers only ever go up (samples
+// overwritten during a slow transfer leave a gap).
+//====================================================
+static bool check_records(const std::string &data, const char *format)
+{
+    std::vector<uint32_t> seqs;
+
+    if (!strcmp(format, "bin"))
+    {
+        if (data.size() < 8 || data.compare(0, 4, "BARO") != 0 || (data.size() - 8) % HTTP_BINARY_RECORD)
+            return false;
+        for (size_t i = 8; i < data.size(); i += HTTP_BINARY_RECORD)
+        {
+            const uint8_t *r = (const uint8_t *)data.data() + i;
+            seqs.push_back(r[0] | r[1] << 8 | r[2] << 16 | (uint32_t)r[3] << 24);
+        }
+    }
+    else if (!strcmp(format, "csv"))
+    {
+        size_t pos = data.find("\r\n");
+        if (pos == std::string::npos || data.compare(0, 4, "seq,") != 0)
+            return false;
+        for (pos += 2; pos < data.size(); pos = data.find("\r\n", pos) + 2)
+            seqs.push_back(strtoul(data.c_str() + pos, NULL, 10));
+    }
+    else
+    {
+        if (data.size() < 3 || data[0] != '[' || data.compare(data.size() - 2, 2, "]\n") != 0)
+            return false;
+        for (size_t pos = 0; (pos = data.find("{\"seq\":", pos)) != std::string::npos; pos++)
+            seqs.push_back(strtoul(data.c_str() + pos + 7, NULL, 10));
+    }
+
+    if (seqs.empty() || seqs.size() > LOAD_HISTORY)
+        return false;
+    for (size_t i = 1; i < seqs.size(); i++)
+        if (seqs[i] <= seqs[i - 1])
+            return false;
+    return true;
+}
+
+static void history_client(int requests, client_result &r)
+{
+    static const char *formats[] = {"json", "csv", "bin"};
+
+    for (int i = 0; i < requests; i++)
+    {
+        const char *format = formats[i % 3];
+        std::string response, data;
+        double t0 = wall_ms();
+
+        int fd = connect_server();
+        if (fd < 0)
+        {
+            r.errors++;
+            continue;
+        }
+        bool ok = send_all(fd, std::string("GET /history?format=") + format + " HTTP/1.1\r\nHost: baro\r\n\r\n") &&
+                  read_all(fd, response);
+        close(fd);
+
+        // The server closes a turned away connection without reading the request, which may end in a reset
+        if (response.compare(0, 12, "HTTP/1.1 503") == 0)
+        {
+            r.busy++;
+            i--;
+            usleep(1000);
+            continue;
+        }
+
+        size_t body = response.find("\r\n\r\n");
+        ok = ok && response.compare(0, 12, "HTTP/1.1 200") == 0 && body != std::string::npos &&
+             dechunk(response.substr(body + 4), data) && check_records(data, format);
+        if (!ok)
+        {
+            r.errors++;
+            continue;
+        }
+        r.requests++;
+        r.bytes += response.size();
+        r.latency_ms.push_back((float)(wall_ms() - t0));
+    }
+    r.done_ms = wall_ms();
+}
+
+//====================================================
+// live_session: Reads SSE events for a while, checking
+// consecutive ids. Returns the last id, or -1 on error.
+//====================================================
+static long live_session(long last_id, double seconds, client_result &r)
+{
+    std::string request = "GET /live HTTP/1.1\r\nHost: baro\r\nAccept: text/event-stream\r\n";
+    std::string stream;
+    char buf[2048];
+    ssize_t n;
+
+    if (last_id >= 0)
+        request += "Last-Event-ID: " + std::to_string(last_id) + "\r\n";
+    request += "\r\n";
+
+    int fd;
+    for (;;)
+    {
+        fd = connect_server();
+        if (fd < 0 || !send_all(fd, request))
+            return -1;
+        n = recv(fd, buf, sizeof(buf), 0);
+        if (n < 12 || memcmp(buf, "HTTP/1.1 503", 12) != 0)
+            break;
+        close(fd);
+        r.busy++;
+        usleep(1000);
+    }
+
+    double end = wall_ms() + seconds * 1000.0;
+    for (; n > 0; n = wall_ms() < end ? recv(fd, buf, sizeof(buf), 0) : 0)
+    {
+        stream.append(buf, n);
+        r.bytes += n;
+        size_t pos;
+        while ((pos = stream.find("\nid: ")) != std::string::npos)
+        {
+            long id = strtol(stream.c_str() + pos + 5, NULL, 10);
+            if (last_id >= 0 && id != last_id + 1)
+            {
+                close(fd);
+                return -1;
+            }
+            last_id = id;
+            r.events++;
+            stream.erase(0, pos + 5);
+        }
+    }
+    close(fd);
+    return last_id;
+}
+
+static void live_client(double seconds, client_result &r)
+{
+    long id = live_session(-1, seconds / 2, r);
+    if (id < 0)
+    {
+        r.errors++;
+        return;
+    }
+    r.requests++;
+    usleep(200000); // Miss a few samples, the resume must deliver them
+    if (live_session(id, seconds / 2, r) < 0)
+        r.errors++;
+    else
+        r.requests++;
+}
+
+static float percentile(std::vector<float> &v, float p)
+{
+    if (v.empty())
+        return 0;
+    size_t i = (size_t)(p / 100.0f * (v.size() - 1));
+    std::nth_element(v.begin(), v.begin() + i, v.end());
+    return v[i];
+}
+
+static void usage(const char *name)
+{
+    fprintf(stderr, "Usage: %s [-c history clients] [-r requests per client] [-l live clients]\n"
+                    "          [-d live seconds] [-p producer interval ms]\n",
+            name);
+}
+
+int main(int argc, char **argv)
+{
+    int history_clients = 16, requests = 60, live_clients = 2, produce_ms = 50;
+    double live_seconds = 3;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "c:r:l:d:p:h")) != -1)
+    {
+        switch (opt)
+        {
+        case 'c':
+            history_clients = atoi(optarg);
+            break;
+        case 'r':
+            requests = atoi(optarg);
+            break;
+        case 'l':
+            live_clients = atoi(optarg);
+            break;
+        case 'd':
+            live_seconds = atof(optarg);
+            break;
+        case 'p':
+            produce_ms = atoi(optarg);
+            break;
+        default:
+            usage(argv[0]);
+            return 2;
+        }
+    }
+
+    static baro_sample storage[LOAD_HISTORY];
+    SampleHistory history(storage, LOAD_HISTORY);
+    PosixTransport net;
+    HistoryHttpServer server(net, history);
+
+    Serial.setOutput(NULL);
+    for (int i = 0; i < LOAD_HISTORY; i++)
+        history.push({(uint32_t)i * 5000, 101325 + i % 40, 2150, 4500});
+    if (!server.begin(0))
+    {
+        fprintf(stderr, "Cannot listen on 127.0.0.1\n");
+        return 2;
+    }
+    server_port = net.port();
+
+    std::vector<client_result> results(history_clients + live_clients);
+    std::vector<std::thread> threads;
+    double t0 = wall_ms();
+
+    for (int i = 0; i < history_clients; i++)
+        threads.emplace_back(history_client, requests, std::ref(results[i]));
+    for (int i = 0; i < live_clients; i++)
+        threads.emplace_back(live_client, live_seconds, std::ref(results[history_clients + i]));
+    std::thread joiner([&threads]() {
+        for (auto &t : threads)
+            t.join();
+        stop_server = true;
+    });
+
+    // The firmware's loop(): poll the server, push a sample now and then, keep the virtual clock on wall time
+    double last_ms = t0, next_sample = t0;
+    uint32_t seq = LOAD_HISTORY;
+    while (!stop_server || server.clients() > 0)
+    {
+        double now = wall_ms();
+        host_advance_ms((uint32_t)(now - last_ms));
+        last_ms += (uint32_t)(now - last_ms);
+        if (now >= next_sample)
+        {
+            history.push({millis(), 101325 + (int32_t)(seq++ % 40), 2150, 4500});
+            next_sample += produce_ms;
+        }
+        if (!server.poll())
+            usleep(50);
+    }
+    joiner.join();
+    double history_s = 0;
+    for (int i = 0; i < history_clients; i++)
+        history_s = std::max(history_s, (results[i].done_ms - t0) / 1000.0);
+
+    client_result total = {};
+    uint64_t history_bytes = 0;
+    for (int i = 0; i < history_clients; i++)
+        history_bytes += results[i].bytes;
+    for (auto &r : results)
+    {
+        total.requests += r.requests;
+        total.busy += r.busy;
+        total.errors += r.errors;
+        total.bytes += r.bytes;
+        total.events += r.events;
+        total.latency_ms.insert(total.latency_ms.end(), r.latency_ms.begin(), r.latency_ms.end());
+    }
+
+    const http_stats &s = server.stats();
+    printf("clients      %d history + %d live, %d connection slots\n", history_clients, live_clients,
+           HTTP_MAX_CLIENTS);
+    printf("requests     %u ok, %u turned away (503), %u errors\n", total.requests, total.busy, total.errors);
+    printf("history      %.0f req/s, %.2f MB/s over %.2f s\n", total.latency_ms.size() / history_s,
+           history_bytes / history_s / 1e6, history_s);
+    printf("latency      p50 %.2f ms, p95 %.2f ms, p99 %.2f ms\n", percentile(total.latency_ms, 50),
+           percentile(total.latency_ms, 95), percentile(total.latency_ms, 99));
+    printf("live         %u events over reconnects\n", total.events);
+    printf("server       %u requests, %u busy, %u bytes, %u samples skipped, %u slots max\n", s.requests, s.busy,
+           s.bytes, s.skipped, s.max_clients);
+    printf("server RAM   %u bytes (%u per connection), history %u bytes\n", (unsigned)sizeof(server),
+           (unsigned)HistoryHttpServer::connection_size(), (unsigned)sizeof(storage));
+
+    if (total.errors > 0)
+    {
+        printf("FAIL\n");
+        return 1;
+    }
+    printf("PASS\n");
+    return 0;
+}
@@ -0,0 +1,309 @@
+//====================================================
+// i2c_fault_bench: Runs the barometer firmware (setup()
+// and loop() from src/main.cpp) on the host emulator
+// and breaks the I2C bus under it with the Wire fake.
+//
+// Usage: i2c_fault_bench [-o dir] [-v]
+//
+//   -o  write a snapshot PPM of the stale display of
+//       every scenario to dir
+//   -v  echo the firmware's serial output
+//
+// First the barometer powers up with the sensors not
+// answering. Then each scenario injects one fault into
+// a healthy barometer and runs loop() until it reads
+// again. Reported per scenario:
+//
+//   detect   fault to first failed reading [s], the
+//            sampler decides when the next reading is,
+//            timed faults last that much longer
+//   blocked  longest reading or recovery attempt [ms]
+//   after    fault gone (or clearable) to the next good
+//            reading [ms], what the backoff adds
+//   loops    loop() calls while faulty, the display
+//            keeps updating
+//   stale    orange stale value seen on screen
+//   garbage  readings of a failed transfer that reached
+//            the fusion and were rejected as outliers
+//            instead of reported as failed
+//   hours    hour slot shifts, one per hour that went
+//            by, also the hours missed while the sensor
+//            was lost, with the meter remapped to match
+//
+// A soak run then injects random SDA-low faults in the
+// middle of transfers for a day. Exits 1 if a fault is
+// not recovered, a reading blocks for longer than
+// BENCH_MAX_BLOCK_MS, recovery takes longer than the
+// backoff allows, the screen does not show staleness
+// while the sensor is gone, or a failed transfer is
+// taken for a reading, the hour slots no longer match
+// their hours, or the sensor driver allocates again
+// after the sensors were first found.
+//====================================================
+
+#include <Arduino.h>
+#include <Wire.h>
+#include <Adafruit_BMP280.h>
+#include <TFT_eSPI.h>
+#include <i2c_health.h>
+#include <adaptive_sampler.h>
+#include <sensor_fusion.h>
+#include <pressure_pipeline.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define BENCH_SETTLE_MS 600000     // Healthy running between scenarios
+#define BENCH_BOOT_FAULT_MS 60000  // Sensors not answering after power-up
+#define BENCH_MAX_BLOCK_MS 200     // One reading, including timeouts and a recovery attempt
+#define BENCH_MAX_AFTER_MS 40000   // Backoff maximum plus a reading
+#define BENCH_CLEAR_AFTER_MS 1000  // Faults the bus clear fixes
+#define BENCH_SOAK_MS 86400000     // One day
+#define BENCH_SOAK_RATE 2e-5f      // Random faults per transfer
+#define BENCH_MAX_LOOPS 200000
+
+void setup(void);
+void loop(void);
+
+extern TFT_eSPI tft;
+extern I2cHealth i2c_health;
+extern AdaptiveSampler sampler;
+extern SensorFusion fusion;
+extern int16_t *pressure_data;
+extern int16_t *meter_data;
+extern int16_t range_min, range_max;
+extern uint32_t next_shift_ms;
+
+struct bench_scenario
+{
+    const char *name;
+    host_i2c_fault fault;
+    uint32_t duration_ms; // 0 = until cleared
+    uint8_t addr;         // 0 = every device
+    uint8_t release_pulses;
+    bool stale;           // Display must show staleness
+    uint32_t max_after_ms;
+};
+
+static const bench_scenario scenarios[] = {
+    {"SDA low, 9 clocks free it", I2C_FAULT_SDA_LOW, 0, 0, 9, true, BENCH_CLEAR_AFTER_MS},
+    {"SDA low, 3 clocks free it", I2C_FAULT_SDA_LOW, 0, 0, 3, true, BENCH_CLEAR_AFTER_MS},
+    {"both sensors gone 90 s", I2C_FAULT_NACK, 90000, 0, 0, true, BENCH_MAX_AFTER_MS},
+    {"SCL held low 20 s", I2C_FAULT_SCL_LOW, 20000, 0, 0, true, BENCH_MAX_AFTER_MS},
+    {"SDA latched 10 min", I2C_FAULT_SDA_LOW, 600000, 0, 0, true, BENCH_MAX_AFTER_MS},
+    {"both sensors gone 3 h", I2C_FAULT_NACK, 10800000, 0, 0, true, BENCH_MAX_AFTER_MS},
+    {"0x77 gone 10 min", I2C_FAULT_NACK, 600000, BMP280_ADDRESS, 0, false, 0},
+};
+
+static bool stale_on_screen(void)
+{
+    for (int32_t y = 128; y < 156; y++)
+        for (int32_t x = 15; x < tft.width(); x++)
+            if (tft.readPixel(x, y) == TFT_ORANGE)
+                return true;
+    return false;
+}
+
+static uint32_t fusion_rejects(void)
+{
+    uint32_t n = 0;
+    for (uint8_t i = 0; i < fusion.count(); i++)
+        n += fusion.rejects(i);
+    return n;
+}
+
+//====================================================
+// mark_slots: Gives every hour slot a value of its own,
+// so check_slots() can tell where each one went, and
+// maps them onto the meter as the firmware would.
+//====================================================
+static void mark_slots(void)
+{
+    pressure_window window = {range_min, range_max};
+
+    for (uint8_t i = 0; i < MAXHOURTIMESLOT; i++)
+        pressure_data[i] = pressure_data[0] + i;
+    baro_map_slots(pressure_data, meter_data, MAXHOURTIMESLOT, window, true);
+}
+
+//====================================================
+// check_slots: The marked slots moved back by exactly
+// 'shifts' hours, and the meter shows the slots in the
+// current window.
+//====================================================
+static bool check_slots(int16_t first, uint32_t shifts)
+{
+    pressure_window window = {range_min, range_max};
+
+    for (uint8_t i = 0; i + shifts < MAXHOURTIMESLOT; i++)
+        if (pressure_data[i + shifts] != first + i)
+            return false;
+    for (uint8_t i = 0; i < MAXHOURTIMESLOT; i++)
+        if (meter_data[i] != baro_to_meter(pressure_data[i], window))
+            return false;
+    return true;
+}
+
+static void run_for(uint32_t ms)
+{
+    uint32_t start = millis();
+    while (millis() - start < ms)
+        loop();
+}
+
+int main(int argc, char **argv)
+{
+    const char *dir = NULL;
+    bool verbose = false;
+    bool pass = true;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "o:v")) != -1)
+    {
+        switch (opt)
+        {
+        case 'o':
+            dir = optarg;
+            break;
+        case 'v':
+            verbose = true;
+            break;
+        default:
+            fprintf(stderr, "Usage: %s [-o dir] [-v]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    Serial.setOutput(verbose ? stdout : NULL);
+    if (dir)
+        mkdir(dir, 0755);
+
+    // Power-up with the sensors not answering, setup() must not wait for them
+    Wire.injectFault(I2C_FAULT_NACK, BENCH_BOOT_FAULT_MS);
+    setup();
+    bool boot_stale = false;
+    uint32_t boot_loops = 0;
+    while (!i2c_health.healthy() && boot_loops < BENCH_MAX_LOOPS)
+    {
+        loop();
+        boot_loops++;
+        boot_stale = boot_stale || (!i2c_health.healthy() && stale_on_screen());
+    }
+    uint32_t allocations = Adafruit_BMP280::allocations(); // One per sensor, when it first answered
+    bool boot_ok = i2c_health.healthy() && boot_stale && millis() <= BENCH_BOOT_FAULT_MS + BENCH_MAX_AFTER_MS;
+    pass = pass && boot_ok;
+    printf("power-up without sensors for %u s: first reading at %.1f s, %u loops before, stale shown %s, "
+           "%u driver allocations%s\n\n",
+           BENCH_BOOT_FAULT_MS / 1000, millis() / 1000.0, boot_loops, boot_stale ? "yes" : "no", allocations,
+           boot_ok ? "" : "  FAIL");
+    run_for(BENCH_SETTLE_MS);
+
+    printf("%-28s %8s %9s %9s %7s %6s %8s %6s\n", "scenario", "detect s", "blocked", "after ms", "loops", "stale",
+           "garbage", "hours");
+    for (size_t n = 0; n < sizeof(scenarios) / sizeof(scenarios[0]); n++)
+    {
+        const bench_scenario &sc = scenarios[n];
+        i2c_health_stats before = i2c_health.stats();
+        uint32_t rejects = fusion_rejects();
+        uint32_t injected = millis();
+        uint32_t lead = sampler.interval(); // The firmware idles until its next reading, the fault outlasts that
+        uint32_t duration = sc.duration_ms ? lead + sc.duration_ms : 0;
+        uint32_t detected = 0, clearable = injected + duration;
+        uint32_t loops = 0;
+        bool seen_stale = false, recovered = false;
+
+        mark_slots();
+        int16_t first = pressure_data[0];
+        uint32_t shift_due = next_shift_ms;
+        Wire.injectFault(sc.fault, duration, sc.addr, sc.release_pulses);
+
+        while (loops < BENCH_MAX_LOOPS)
+        {
+            loop();
+            if (detected == 0 && i2c_health.stats().faults > before.faults)
+                detected = millis();
+            if (!i2c_health.healthy())
+            {
+                loops++;
+                if (stale_on_screen() && !seen_stale)
+                {
+                    seen_stale = true;
+                    if (dir)
+                    {
+                        char path[512];
+                        snprintf(path, sizeof(path), "%s/stale_%zu.ppm", dir, n);
+                        tft.writeSnapshotPPM(path);
+                    }
+                }
+            }
+            bool fault_over = Wire.fault() == I2C_FAULT_NONE && (int32_t)(millis() - clearable) >= 0;
+            if (sc.stale && detected && i2c_health.healthy())
+            {
+                recovered = true;
+                break;
+            }
+            if (!sc.stale && fault_over)
+            {
+                recovered = i2c_health.healthy();
+                break;
+            }
+        }
+
+        const i2c_health_stats &s = i2c_health.stats();
+        uint32_t after = recovered && sc.stale ? millis() - clearable : 0;
+        if (sc.stale && detected && (int32_t)(detected - clearable) > 0)
+            after = millis() - detected; // Detected after the fault was already clearable
+        uint32_t garbage = fusion_rejects() - rejects; // No glitches configured, every reject is a failed read
+        uint32_t shifts = (next_shift_ms - shift_due) / HOURSLOT_MS;
+        bool ok = recovered && s.max_read_ms <= BENCH_MAX_BLOCK_MS && seen_stale == sc.stale &&
+                  (!sc.stale || after <= sc.max_after_ms) && garbage == 0 && check_slots(first, shifts);
+        pass = pass && ok;
+
+        printf("%-28s %8.1f %6u ms %9u %7u %6s %8u %6u%s\n", sc.name,
+               detected ? (detected - injected) / 1000.0 : 0.0, s.max_read_ms, after, loops, seen_stale ? "yes" : "no",
+               garbage, shifts, ok ? "" : "  FAIL");
+
+        Wire.injectFault(I2C_FAULT_NONE, 0);
+        run_for(BENCH_SETTLE_MS);
+    }
+
+    // Soak: faults start in the middle of readings, every transfer after that runs into the timeout
+    i2c_health_stats before = i2c_health.stats();
+    host_i2c_stats bus_before = Wire.stats();
+    uint32_t rejects = fusion_rejects();
+    Wire.setFaultRate(BENCH_SOAK_RATE, I2C_FAULT_SDA_LOW, 0, 9);
+    run_for(BENCH_SOAK_MS);
+    Wire.setFaultRate(0.0f, I2C_FAULT_NONE, 0);
+    run_for(BENCH_SETTLE_MS);
+
+    const i2c_health_stats &s = i2c_health.stats();
+    const host_i2c_stats &bus = Wire.stats();
+    uint32_t faults = s.faults - before.faults;
+    uint32_t recoveries = s.recoveries - before.recoveries;
+    uint32_t injected = bus.faults - bus_before.faults;
+    uint32_t garbage = fusion_rejects() - rejects;
+    bool soak_ok = injected > 0 && faults == injected && recoveries == faults && i2c_health.healthy() &&
+                   s.max_read_ms <= BENCH_MAX_BLOCK_MS && garbage == 0;
+    pass = pass && soak_ok;
+
+    printf("\nsoak 24 h: %u faults injected, %u detected, %u recovered, %u readings, %u timeouts, %u clears, "
+           "%u garbage\n",
+           injected, faults, recoveries, s.readings - before.readings, bus.timeouts - bus_before.timeouts,
+           s.bus_clears - before.bus_clears, garbage);
+    printf("recovery mean %u ms, max %u ms (all faults), longest reading %u ms%s\n",
+           s.recoveries ? (uint32_t)(s.total_recovery_ms / s.recoveries) : 0, s.max_recovery_ms, s.max_read_ms,
+           soak_ok ? "" : "  FAIL");
+
+    uint32_t late = Adafruit_BMP280::allocations() - allocations;
+    pass = pass && late == 0;
+    printf("sensor driver allocations after the sensors were found: %u%s\n", late, late ? "  FAIL" : "");
+
+    if (!pass)
+    {
+        printf("\nFAIL\n");
+        return 1;
+    }
+    printf("\nPASS: every fault recovered, readings blocked at most %u ms, staleness shown while the sensor was gone, "
+           "no failed transfer taken for a reading\n",
+           s.max_read_ms);
+    return 0;
+}
@@ -0,0 +1,230 @@
+//====================================================
+// sampling_bench: Adaptive vs. fixed 5 s sampling on
+// synthetic 24 h pressure traces (sea level, Pa) with
+// 0.75 Pa sensor noise.
+//
+//   calm    semi-diurnal tide only, 1 hPa amplitude
+//   front   tide, then -2 hPa/h for 6 h from 06:00
+//   squall  tide, +3 hPa in 5 min at 12:00 decaying
+//           over an hour, 30 min of 5 Pa gusts
+//
+// Reported per trace and sampler:
+//
+//   reads    readings in 24 h (I2C conversions)
+//   track    rms and max error of the last reading vs.
+//            the trace, every second [Pa]
+//   hour     max error of the hourly roll-up vs. the
+//            true hourly mean [Pa], time weighted and
+//            plain average of the readings
+//
+// and the interval distribution of the adaptive runs.
+// Hour roll-ups are taken on the hour, where the
+// firmware cuts a longer interval short, against the
+// true mean over the same stretch. Until the next reading a change can
+// not be seen, so the squall is caught within the
+// longest interval (5 min) and tracking error peaks
+// there.
+//
+// Exits 1 unless the adaptive sampler reads at least 10x
+// less in calm weather, goes to 1 s within 150 s of
+// the squall, has rms tracking error within 2x the fixed
+// sampler plus the step size, and the time weighted
+// roll-up stays within 1 Pa.
+//====================================================
+
+#include <Arduino.h>
+#include <adaptive_sampler.h>
+#include <time_weighted_mean.h>
+
+#define BENCH_HOURS 24
+#define BENCH_FIXED_MS 5000
+#define BENCH_NOISE_PA 0.75f
+#define BENCH_BASE_PA 101300.0f
+#define BENCH_STEP_PA 2.0f // AdaptiveSampler defaults, as in the firmware
+#define BENCH_SQUALL_S 150 // Squall start to 1 s intervals, as the README states
+
+struct bench_result
+{
+    uint32_t reads;
+    float track_rms_pa;
+    float track_max_pa;
+    float hour_tw_pa;    // Time weighted roll-up, max error
+    float hour_plain_pa; // Plain average roll-up, max error
+    float detect_s;      // Squall start to the first 1 s interval
+    AdaptiveSampler sampler;
+};
+
+typedef float (*bench_trace)(float s);
+
+static float tide(float s)
+{
+    return BENCH_BASE_PA + 100.0f * sinf(2.0f * (float)M_PI * s / 43200.0f);
+}
+
+static float trace_calm(float s)
+{
+    return tide(s);
+}
+
+static float trace_front(float s)
+{
+    float h = s / 3600.0f;
+    if (h < 6.0f)
+        return tide(s);
+    if (h < 12.0f)
+        return tide(s) - 200.0f * (h - 6.0f);
+    return tide(s) - 1200.0f;
+}
+
+static float trace_squall(float s)
+{
+    float p = tide(s);
+    if (s >= 43200.0f)
+    {
+        float m = (s - 43200.0f) / 60.0f; // Minutes into the squall
+        p += m < 5.0f ? 60.0f * m : 300.0f * expf(-(m - 5.0f) / 60.0f);
+        if (m < 30.0f)
+        {
+            // Gusts: a new random level every 2 s, deterministic per time
+            uint32_t hash = (uint32_t)(s / 2.0f) * 2654435761u;
+            p += 5.0f * ((hash >> 8) / 8388608.0f - 1.0f);
+        }
+    }
+    return p;
+}
+
+static uint32_t noise_state = 12345;
+
+static float noise(void)
+{
+    float u1, u2;
+    noise_state = noise_state * 1664525u + 1013904223u;
+    u1 = ((noise_state >> 8) + 1) / 16777217.0f;
+    noise_state = noise_state * 1664525u + 1013904223u;
+    u2 = (noise_state >> 8) / 16777216.0f;
+    return BENCH_NOISE_PA * sqrtf(-2.0f * logf(u1)) * cosf(2.0f * (float)M_PI * u2);
+}
+
+//====================================================
+// run: Samples the trace for BENCH_HOURS, at a fixed
+// interval or as the sampler says, and scores it.
+//====================================================
+static void run(bench_trace trace, bool adaptive, bench_result &r)
+{
+    TimeWeightedMean hour_mean;
+    double plain_sum = 0.0, true_sum = 0.0, track_sum2 = 0.0;
+    uint32_t plain_n = 0, true_n = 0, next_ms = 0, hour = 0;
+    float last_pa = 0.0f;
+
+    noise_state = 12345;
+    r.reads = 0;
+    r.track_max_pa = r.hour_tw_pa = r.hour_plain_pa = 0.0f;
+    r.detect_s = NAN;
+
+    for (uint32_t s = 0; s < BENCH_HOURS * 3600u; s++)
+    {
+        uint32_t t_ms = s * 1000u;
+
+        if (t_ms >= next_ms)
+        {
+            float p = trace(s) + noise();
+            uint32_t interval = adaptive ? r.sampler.update(t_ms, p) : BENCH_FIXED_MS;
+            hour_mean.add(t_ms, p);
+            plain_sum += p;
+            plain_n++;
+            r.reads++;
+            last_pa = p;
+            next_ms = t_ms + interval;
+            if (next_ms > (s / 3600 + 1) * 3600000u)
+                next_ms = (s / 3600 + 1) * 3600000u; // The firmware reads when the hour slot ends, see loop()
+            if (s >= 43200 && interval <= 1000 && isnan(r.detect_s))
+                r.detect_s = s - 43200.0f;
+
+            // Hour roll-up at the first reading of a new hour, as the firmware shifts its hour slots
+            if (s / 3600 != hour && true_n > 0)
+            {
+                float true_mean = (float)(true_sum / true_n);
+                float tw = fabsf(hour_mean.mean() - true_mean);
+                float plain = fabsf((float)(plain_sum / plain_n) - true_mean);
+                if (tw > r.hour_tw_pa)
+                    r.hour_tw_pa = tw;
+                if (plain > r.hour_plain_pa)
+                    r.hour_plain_pa = plain;
+                hour_mean.restart();
+                plain_sum = p;
+                plain_n = 1;
+                true_sum = 0.0;
+                true_n = 0;
+            }
+            hour = s / 3600;
+        }
+
+        float e = fabsf(last_pa - trace(s));
+        track_sum2 += (double)e * e;
+        if (e > r.track_max_pa)
+            r.track_max_pa = e;
+        true_sum += trace(s);
+        true_n++;
+    }
+    r.track_rms_pa = (float)sqrt(track_sum2 / (BENCH_HOURS * 3600.0));
+}
+
+static void print_result(const char *trace, const char *sampler, const bench_result &r)
+{
+    printf("%-8s %-9s %8u %10.2f %10.2f %10.2f %10.2f\n", trace, sampler, r.reads, r.track_rms_pa, r.track_max_pa,
+           r.hour_tw_pa, r.hour_plain_pa);
+}
+
+static void print_distribution(const char *trace, const AdaptiveSampler &sampler)
+{
+    float total = 0.0f;
+
+    for (uint8_t i = 0; i < SAMPLER_BUCKETS; i++)
+        total += sampler.bucket(i).seconds;
+
+    printf("%-8s", trace);
+    for (uint8_t i = 0; i < SAMPLER_BUCKETS; i++)
+        printf(" %5u/%4.1f%%", sampler.bucket(i).samples, total > 0 ? 100.0f * sampler.bucket(i).seconds / total : 0);
+    printf("\n");
+}
+
+int main(void)
+{
+    static const char *names[] = {"calm", "front", "squall"};
+    static const bench_trace traces[] = {trace_calm, trace_front, trace_squall};
+    bench_result fixed[3], adaptive[3];
+    bool pass = true;
+
+    printf("%-8s %-9s %8s %10s %10s %10s %10s\n", "trace", "sampler", "reads", "track rms", "track max",
+           "hour tw", "hour plain");
+    for (int i = 0; i < 3; i++)
+    {
+        run(traces[i], false, fixed[i]);
+        print_result(names[i], "fixed 5s", fixed[i]);
+        run(traces[i], true, adaptive[i]);
+        print_result(names[i], "adaptive", adaptive[i]);
+
+        pass &= adaptive[i].track_rms_pa <= 2.0f * fixed[i].track_rms_pa + BENCH_STEP_PA;
+        pass &= adaptive[i].hour_tw_pa <= 1.0f;
+    }
+
+    printf("\nreadings/time share per interval bucket (adaptive)\n%-8s", "");
+    for (uint8_t i = 0; i < SAMPLER_BUCKETS; i++)
+    {
+        uint32_t upto = adaptive[0].sampler.bucket(i).upto_ms;
+        if (upto == UINT32_MAX)
+            printf("     >%4us", adaptive[0].sampler.bucket(i - 1).upto_ms / 1000);
+        else
+            printf("    <=%4us", upto / 1000);
+    }
+    printf("\n");
+    for (int i = 0; i < 3; i++)
+        print_distribution(names[i], adaptive[i].sampler);
+
+    pass &= adaptive[0].reads * 10 <= fixed[0].reads;
+    pass &= adaptive[2].detect_s <= BENCH_SQUALL_S;
+    printf("\n%s: calm %u vs %u readings, squall at 1 s intervals %.0f s after it started\n", pass ? "PASS" : "FAIL",
+           adaptive[0].reads, fixed[0].reads, adaptive[2].detect_s);
+
+    return pass ? 0 : 1;
+}
@@ -0,0 +1,204 @@
+//====================================================
+// tft_emulator: Runs the barometer firmware (setup()
+// and loop() from src/main.cpp) against the host
+// TFT_eSPI framebuffer and reports how many pixels and
+// SPI bytes each frame costs. Frame 0 is setup(), every
+// loop() call after that is one frame.
+//
+// Usage: tft_emulator [-n frames] [-o dir] [-s every]
+//                     [-t swell|front|calm] [-b bytes] [-v]
+//
+//   -n  loop() frames to run (default 8640), one reading
+//       each, virtual time follows the adaptive interval
+//   -o  output directory for frames.csv and PPM files
+//   -s  write snapshot + heatmap PPM every n-th frame,
+//       frame 0 and 1 are always written (0 = none)
+//   -t  pressure trace fed to the fake BMP280
+//   -b  fail (exit 1) if the mean loop() frame sends
+//       more than this many bytes, for regression checks
+//   -v  echo the firmware's serial output
+//====================================================
+
+#include <Arduino.h>
+#include <TFT_eSPI.h>
+#include <Adafruit_BMP280.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <vector>
+#include <algorithm>
+
+void setup(void);
+void loop(void);
+
+extern TFT_eSPI tft;
+
+//====================================================
+// Pressure traces, station pressure in Pa
+//====================================================
+
+static float trace_front(uint32_t ms)
+{
+    // Calm for 2 h, falls 2 hPa/h for 6 h, then recovers at 1 hPa/h
+    float h = ms / 3600000.0f;
+    if (h < 2.0f)
+        return 99800.0f;
+    if (h < 8.0f)
+        return 99800.0f - 200.0f * (h - 2.0f);
+    return 98600.0f + 100.0f * (h - 8.0f);
+}
+
+static float trace_calm(uint32_t ms)
+{
+    (void)ms;
+    return 99800.0f;
+}
+
+static void write_frame_images(const char *dir, int frame)
+{
+    char path[512];
+
+    snprintf(path, sizeof(path), "%s/frame_%05d.ppm", dir, frame);
+    tft.writeSnapshotPPM(path);
+    snprintf(path, sizeof(path), "%s/heat_%05d.ppm", dir, frame);
+    tft.writeHeatmapPPM(path);
+}
+
+int main(int argc, char **argv)
+{
+    int frames = 8640;
+    int snapshot_every = 720;
+    long budget = 0;
+    bool verbose = false;
+    const char *dir = "emu_out";
+    int opt;
+
+    while ((opt = getopt(argc, argv, "n:o:s:t:b:v")) != -1)
+    {
+        switch (opt)
+        {
+        case 'n':
+            frames = atoi(optarg);
+            break;
+        case 'o':
+            dir = optarg;
+            break;
+        case 's':
+            snapshot_every = atoi(optarg);
+            break;
+        case 't':
+            if (strcmp(optarg, "front") == 0)
+                Adafruit_BMP280::setTrace(trace_front, NULL);
+            else if (strcmp(optarg, "calm") == 0)
+                Adafruit_BMP280::setTrace(trace_calm, NULL);
+            else if (strcmp(optarg, "swell") != 0)
+            {
+                fprintf(stderr, "Unknown trace '%s'\n", optarg);
+                return 2;
+            }
+            break;
+        case 'b':
+            budget = atol(optarg);
+            break;
+        case 'v':
+            verbose = true;
+            break;
+        default:
+            fprintf(stderr, "Usage: %s [-n frames] [-o dir] [-s every] [-t swell|front|calm] [-b bytes] [-v]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    Serial.setOutput(verbose ? stdout : NULL);
+    mkdir(dir, 0755);
+
+    char path[512];
+    snprintf(path, sizeof(path), "%s/frames.csv", dir);
+    FILE *csv = fopen(path, "w");
+    if (csv == NULL)
+    {
+        fprintf(stderr, "Cannot write %s\n", path);
+        return 2;
+    }
+    fprintf(csv, "frame,ms,pixels,unique,changed,max_writes,windows,bytes,bus_ms");
+    for (int p = 0; p < TFT_PRIM_COUNT; p++)
+        fprintf(csv, ",%s_bytes", TFT_eSPI::primitiveName(p));
+    fprintf(csv, "\n");
+
+    std::vector<uint32_t> loop_bytes;
+    tft_prim_stats prim_total[TFT_PRIM_COUNT] = {};
+    uint64_t total_pixels = 0, total_unique = 0, total_changed = 0;
+    tft_frame_stats setup_stats = {};
+
+    for (int frame = 0; frame <= frames; frame++)
+    {
+        tft.beginFrame();
+        if (frame == 0)
+            setup();
+        else
+            loop();
+        const tft_frame_stats &s = tft.endFrame();
+
+        fprintf(csv, "%d,%u,%u,%u,%u,%u,%u,%u,%.3f", frame, millis(), s.pixels, s.unique_pixels,
+                s.changed_pixels, s.max_writes, s.windows, s.bytes, s.bus_ms());
+        for (int p = 0; p < TFT_PRIM_COUNT; p++)
+            fprintf(csv, ",%u", s.prim[p].bytes);
+        fprintf(csv, "\n");
+
+        if (frame <= 1 || (snapshot_every > 0 && frame % snapshot_every == 0))
+            write_frame_images(dir, frame);
+
+        if (frame == 0)
+        {
+            setup_stats = s;
+            continue;
+        }
+
+        loop_bytes.push_back(s.bytes);
+        total_pixels += s.pixels;
+        total_unique += s.unique_pixels;
+        total_changed += s.changed_pixels;
+        for (int p = 0; p < TFT_PRIM_COUNT; p++)
+        {
+            prim_total[p].calls += s.prim[p].calls;
+            prim_total[p].windows += s.prim[p].windows;
+            prim_total[p].pixels += s.prim[p].pixels;
+            prim_total[p].bytes += s.prim[p].bytes;
+        }
+    }
+    fclose(csv);
+
+    if (loop_bytes.empty())
+        return 0;
+
+    std::vector<uint32_t> sorted = loop_bytes;
+    std::sort(sorted.begin(), sorted.end());
+    uint64_t sum = 0;
+    for (uint32_t b : loop_bytes)
+        sum += b;
+    double mean = (double)sum / loop_bytes.size();
+    double n = (double)loop_bytes.size();
+
+    printf("setup(): %u px, %u windows, %u bytes, %.2f ms bus\n", setup_stats.pixels, setup_stats.windows,
+           setup_stats.bytes, setup_stats.bus_ms());
+    printf("loop() x %zu: bytes/frame min %u, median %u, max %u, mean %.0f (%.3f ms bus)\n", loop_bytes.size(),
+           sorted.front(), sorted[sorted.size() / 2], sorted.back(), mean, mean * 8.0 * 1000.0 / SPI_FREQUENCY);
+    printf("loop() pixels/frame: pushed %.0f, distinct %.0f, changed %.1f, overdraw %.0f, efficiency %.2f%%\n",
+           total_pixels / n, total_unique / n, total_changed / n, (total_pixels - total_unique) / n,
+           total_pixels ? 100.0 * total_changed / total_pixels : 100.0);
+    printf("\n%-10s %10s %10s %12s %12s %7s\n", "primitive", "calls/fr", "windows/fr", "pixels/fr", "bytes/fr", "share");
+    for (int p = 0; p < TFT_PRIM_COUNT; p++)
+    {
+        if (prim_total[p].calls == 0 && prim_total[p].bytes == 0)
+            continue;
+        printf("%-10s %10.1f %10.1f %12.1f %12.1f %6.1f%%\n", TFT_eSPI::primitiveName(p), prim_total[p].calls / n,
+               prim_total[p].windows / n, prim_total[p].pixels / n, prim_total[p].bytes / n,
+               sum ? 100.0 * prim_total[p].bytes / sum : 0.0);
+    }
+
+    if (budget > 0 && mean > budget)
+    {
+        printf("\nFAIL: mean loop() frame %.0f bytes exceeds budget %ld\n", mean, budget);
+        return 1;
+    }
+    return 0;
+}